@@ -0,0 +1,124 @@
+//
+// Pinning worker threads to CPUs, and which NUMA node each CPU is on.
+//
+
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <cstdlib>
+#include "Affinity.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifndef __linux__
+static const int CPU_SETSIZE = 1024;
+#endif
+
+//a CPU number, digits only and below CPU_SETSIZE
+static bool parse_cpu(const std::string& text, int& cpu){
+    if(text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos) return false;
+    cpu = atoi(text.c_str());
+    return cpu < CPU_SETSIZE;
+}
+
+bool parse_cpu_list(const std::string& text, std::vector< int >& cpus){
+    cpus.clear();
+    std::istringstream ranges(text);
+    std::string range;
+    while(std::getline(ranges, range, ',')){
+        //the /sys lists end with a newline
+        if(!range.empty() && range[range.size() - 1] == '\n') range.erase(range.size() - 1);
+        std::size_t dash = range.find('-');
+        int first, last;
+        if(dash == std::string::npos){
+            if(!parse_cpu(range, first)) return false;
+            last = first;
+        } else if(!parse_cpu(range.substr(0, dash), first) || !parse_cpu(range.substr(dash + 1), last)){
+            return false;
+        }
+        if(last < first) return false;
+        for(int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return !cpus.empty();
+}
+
+std::string cpu_list_text(const std::vector< int >& cpus){
+    //runs of CPUs written as ranges
+    std::ostringstream text;
+    for(int i = 0; i < cpus.size(); i++){
+        int last = i;
+        while(last + 1 < cpus.size() && cpus[last + 1] == cpus[last] + 1) last++;
+        if(i > 0) text << ",";
+        text << cpus[i];
+        if(last > i) text << "-" << cpus[last];
+        i = last;
+    }
+    return text.str();
+}
+
+std::vector< int > allowed_cpus(){
+    std::vector< int > cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set) == 0){
+        for(int cpu = 0; cpu < CPU_SETSIZE; cpu++){
+            if(CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if(cpus.empty()) cpus.push_back(0);
+    return cpus;
+}
+
+//node of every CPU, by CPU number, -1 for CPUs no node lists
+static std::vector< int > node_of_cpu;
+static int node_count = 1;
+static std::once_flag topology_read;
+
+static void read_topology(){
+    //node directories are numbered from 0 and may have gaps
+    int nodes = 0;
+    for(int node = 0; node < 1024; node++){
+        std::ostringstream name;
+        name << "/sys/devices/system/node/node" << node << "/cpulist";
+        std::ifstream file(name.str().c_str());
+        if(!file.is_open()) continue;
+        std::string text;
+        std::vector< int > cpus;
+        if(!std::getline(file, text) || !parse_cpu_list(text, cpus)) continue;
+        for(int i = 0; i < cpus.size(); i++){
+            if(cpus[i] >= node_of_cpu.size()) node_of_cpu.resize(cpus[i] + 1, -1);
+            node_of_cpu[cpus[i]] = node;
+        }
+        nodes = node + 1;
+    }
+    if(nodes > 0) node_count = nodes;
+}
+
+int cpu_node(int cpu){
+    std::call_once(topology_read, read_topology);
+    if(cpu < 0 || cpu >= node_of_cpu.size() || node_of_cpu[cpu] < 0) return 0;
+    return node_of_cpu[cpu];
+}
+
+int numa_nodes(){
+    std::call_once(topology_read, read_topology);
+    return node_count;
+}
+
+bool pin_worker(const std::vector< int >& cpus, int worker){
+    if(cpus.empty()) return true;
+#ifdef __linux__
+    int cpu = cpus[worker % cpus.size()];
+    if(cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,33 @@
+//
+// Pinning worker threads to CPUs, and which NUMA node each CPU is on.
+//
+
+#ifndef TERMINALAPP_AFFINITY_H
+#define TERMINALAPP_AFFINITY_H
+#include <vector>
+#include <string>
+
+//Linux only; elsewhere, or when /sys can't be read, every CPU is taken
+//to be on node 0 and pinning does nothing. Memory is placed by first
+//touch: Linux puts a page on the node of the thread that first writes
+//it, so a table made and cleared by a pinned worker is local to it.
+
+//"0-3,8,10-11" as a list of CPUs, false if text isn't such a list or
+//names a CPU of CPU_SETSIZE (1024 off Linux) or more
+bool parse_cpu_list(const std::string& text, std::vector< int >& cpus);
+std::string cpu_list_text(const std::vector< int >& cpus);
+
+//CPUs this process may run on, in order
+std::vector< int > allowed_cpus();
+
+//NUMA node of cpu, read from /sys/devices/system/node once
+int cpu_node(int cpu);
+int numa_nodes(); //1 on a machine without NUMA
+
+//Pins the calling thread, worker number worker of a pool, to
+//cpus[worker % cpus.size()]. Does nothing and returns true for an empty
+//list. Returns false if the CPU can't be used, leaving the thread free
+//to run anywhere.
+bool pin_worker(const std::vector< int >& cpus, int worker);
+
+#endif //TERMINALAPP_AFFINITY_H
@@ -0,0 +1,136 @@
+//
+// Scores many leaf boards in one pass for the heuristics which are plain
+// sums over the jars: Alabandi's, Bell's and the simple kalah difference.
+//
+
+#include "BatchEval.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define KALAH_BATCH_AVX2
+#endif
+
+//Every kernel repeats the operations of its heuristic in PlayGame.cpp in
+//the same order, one board per lane, so the doubles round the same way.
+//Alabandi's and Bell's sums must not be fused into multiply-adds on
+//either side for that to hold, which is the case unless FMA code
+//generation is turned on.
+
+void LeafBatch::clear(bool player_max_parameter){
+    player_max = player_max_parameter;
+    size = 0;
+    for(int i = 0; i < 14; i++) jar[i].clear();
+}
+
+void LeafBatch::add(const std::vector< int >& board){
+    for(int i = 0; i < 14; i++) jar[i].push_back(board[i]);
+    size++;
+}
+
+bool batch_heuristic(int heuristic){
+    return heuristic != 2; //coplin's simulates moves, nothing to batch
+}
+
+//scores the boards from first on
+static void score_scalar(const LeafBatch& batch, int heuristic, const Weights& weights, double* scores, int first){
+    const std::vector< int >* jar = batch.jar;
+    if(heuristic == 0){
+        //alabandi_heuristic, read shifted by 7 when max is to move
+        int side = 7 * batch.player_max;
+        for(int k = first; k < batch.size; k++){
+            int kalahs = jar[(6 + side) % 14][k] - jar[(13 + side) % 14][k];
+            int stones = 0;
+            for(int i = 0; i <= 5; i++) stones += jar[(i + side) % 14][k];
+            for(int i = 7; i <= 12; i++) stones -= jar[(i + side) % 14][k];
+            scores[k] = weights.kalah * kalahs + stones;
+        }
+    } else if(heuristic == 1){
+        //bell_heuristic
+        double coeff = weights.bell;
+        for(int k = first; k < batch.size; k++){
+            double score = jar[6][k] - jar[13][k];
+            for(int i = 0; i < 6; i++){
+                if(jar[i][k] < 6 - i) score+= coeff * (jar[i][k]);
+            }
+            for(int i = 7; i < 13; i++){
+                if(jar[i][k] < 13 - i) score-= coeff * (jar[i][k]);
+            }
+            scores[k] = score;
+        }
+    } else{
+        //simple_heuristic
+        for(int k = first; k < batch.size; k++){
+            scores[k] = jar[6][k] - jar[13][k];
+        }
+    }
+}
+
+void evaluate_batch_scalar(const LeafBatch& batch, int heuristic, const Weights& weights, double* scores){
+    score_scalar(batch, heuristic, weights, scores, 0);
+}
+
+#ifdef KALAH_BATCH_AVX2
+__attribute__((target("avx2")))
+static void evaluate_batch_avx2(const LeafBatch& batch, int heuristic, const Weights& weights, double* scores){
+    //four boards at a time, the scalar code takes what is left over
+    const std::vector< int >* jar = batch.jar;
+    int k = 0;
+    if(heuristic == 0){
+        int side = 7 * batch.player_max;
+        __m256d kalah = _mm256_set1_pd(weights.kalah);
+        for(; k + 4 <= batch.size; k += 4){
+            __m128i kalahs = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)&jar[(6 + side) % 14][k]),
+                                           _mm_loadu_si128((const __m128i*)&jar[(13 + side) % 14][k]));
+            __m128i stones = _mm_setzero_si128();
+            for(int i = 0; i <= 5; i++){
+                stones = _mm_add_epi32(stones, _mm_loadu_si128((const __m128i*)&jar[(i + side) % 14][k]));
+            }
+            for(int i = 7; i <= 12; i++){
+                stones = _mm_sub_epi32(stones, _mm_loadu_si128((const __m128i*)&jar[(i + side) % 14][k]));
+            }
+            _mm256_storeu_pd(&scores[k], _mm256_add_pd(_mm256_mul_pd(kalah, _mm256_cvtepi32_pd(kalahs)),
+                                                       _mm256_cvtepi32_pd(stones)));
+        }
+    } else if(heuristic == 1){
+        __m256d coeff = _mm256_set1_pd(weights.bell);
+        for(; k + 4 <= batch.size; k += 4){
+            __m256d score = _mm256_cvtepi32_pd(_mm_sub_epi32(_mm_loadu_si128((const __m128i*)&jar[6][k]),
+                                                            _mm_loadu_si128((const __m128i*)&jar[13][k])));
+            for(int i = 0; i < 6; i++){
+                __m128i seeds = _mm_loadu_si128((const __m128i*)&jar[i][k]);
+                __m256d take = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm_cmplt_epi32(seeds, _mm_set1_epi32(6 - i))));
+                __m256d sum = _mm256_add_pd(score, _mm256_mul_pd(coeff, _mm256_cvtepi32_pd(seeds)));
+                score = _mm256_blendv_pd(score, sum, take);
+            }
+            for(int i = 7; i < 13; i++){
+                __m128i seeds = _mm_loadu_si128((const __m128i*)&jar[i][k]);
+                __m256d take = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm_cmplt_epi32(seeds, _mm_set1_epi32(13 - i))));
+                __m256d sum = _mm256_sub_pd(score, _mm256_mul_pd(coeff, _mm256_cvtepi32_pd(seeds)));
+                score = _mm256_blendv_pd(score, sum, take);
+            }
+            _mm256_storeu_pd(&scores[k], score);
+        }
+    } else{
+        for(; k + 4 <= batch.size; k += 4){
+            __m128i score = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)&jar[6][k]),
+                                          _mm_loadu_si128((const __m128i*)&jar[13][k]));
+            _mm256_storeu_pd(&scores[k], _mm256_cvtepi32_pd(score));
+        }
+    }
+    //leave the upper halves clean, SSE code after this would run slowly
+    _mm256_zeroupper();
+    score_scalar(batch, heuristic, weights, scores, k);
+}
+#endif
+
+void evaluate_batch(const LeafBatch& batch, int heuristic, const Weights& weights, std::vector< double >& scores){
+    scores.resize(batch.size);
+    if(batch.size == 0) return;
+#ifdef KALAH_BATCH_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if(has_avx2){
+        evaluate_batch_avx2(batch, heuristic, weights, scores.data());
+        return;
+    }
+#endif
+    evaluate_batch_scalar(batch, heuristic, weights, scores.data());
+}
@@ -0,0 +1,35 @@
+//
+// Scores many leaf boards in one pass for the heuristics which are plain
+// sums over the jars: Alabandi's, Bell's and the simple kalah difference.
+//
+
+#ifndef TERMINALAPP_BATCHEVAL_H
+#define TERMINALAPP_BATCHEVAL_H
+#include <vector>
+#include "Weights.h"
+
+//Boards stored jar by jar (structure of arrays), so jar[i][k] is jar i of
+//the k-th board. All boards in a batch have the same side to move, as the
+//children of one node do.
+struct LeafBatch{
+    std::vector< int > jar[14];
+    bool player_max;
+    int size;
+
+    LeafBatch() : player_max(false), size(0){}
+    void clear(bool player_max_parameter);
+    void add(const std::vector< int >& board);
+};
+
+//true if evaluate_batch can score this heuristic (numbered as in
+//PlayGame::calculate_heuristic)
+bool batch_heuristic(int heuristic);
+
+//Fills scores with the heuristic of every board, bit for bit what
+//PlayGame::calculate_heuristic gives. Uses AVX2 when the CPU has it.
+void evaluate_batch(const LeafBatch& batch, int heuristic, const Weights& weights, std::vector< double >& scores);
+
+//the same without AVX2, kept callable for comparisons
+void evaluate_batch_scalar(const LeafBatch& batch, int heuristic, const Weights& weights, double* scores);
+
+#endif //TERMINALAPP_BATCHEVAL_H
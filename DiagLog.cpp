@@ -0,0 +1,339 @@
+//
+// Diagnostic output of a game, one record per move, as CSV or as a
+// buffered binary log which can be turned into the same CSV later.
+//
+
+#include <iostream>
+#include <sstream>
+#include <iterator>
+#include <cstring>
+#include "DiagLog.h"
+
+static const char MAGIC[4] = {'K', 'D', 'L', 'G'};
+static const uint32_t VERSION = 3; //2 added the board size, 3 made records variable length
+static const int PATH_LENGTH_2 = 32; //moves of the path versions 1 and 2 kept
+static const int RECORD_SIZE_2 = 4 + 1 + 14 + 8 + 8 + 8 + 8 + 8 + 1 + 1 + 8 * PATH_LENGTH_2;
+static const int RECORD_SIZE_1 = RECORD_SIZE_2 - 1; //every board was Kalah(6,6)
+static const std::size_t BLOCK_SIZE = 1 << 16; //bytes buffered before writing
+
+void write_diag_header(std::ostream& out){
+    out << "Move Index,Max's Score,Min's Score,Children Generated,Move Made,Time to Run,Board,Path,H Score,Budget Hit,Quiescence Nodes\n";
+}
+
+void write_diag_row(std::ostream& out, const DiagRecord& record){
+    //laid out as PlayGame::output_path and main's old diag code wrote it
+    out << record.move_index << ",";
+    out << (int)record.board[record.jars / 2 - 1] << ",";
+    out << (int)record.board[record.jars - 1] << ",";
+    out << record.children_generated << ",";
+    for(int i = 0; i < record.move.size(); i++){
+        if(i > 0) out << " ";
+        out << record.move[i];
+    }
+    if(record.truncated & DiagRecord::TRUNCATED_MOVE) out << " ...";
+    out << "," << record.seconds << ",";
+    out << (int)record.board[0];
+    for(int i = 1; i < record.jars; i++){
+        out << " " << (int)record.board[i];
+    }
+    out << ",";
+    for(int i = 0; i < record.path.size(); i++){
+        for(int j = 0; j < record.path[i].size(); j++){
+            out << record.path[i][j] << " ";
+        }
+        if(i + 1 != record.path.size()) out << "--> ";
+    }
+    if(record.truncated & DiagRecord::TRUNCATED_PATH) out << "--> ...";
+    out << "," << record.heuristic_score;
+    out << "," << (int)record.budget_hit;
+    out << "," << record.quiescence_nodes << "\n";
+}
+
+/******************************************************************************
+ *  Binary log
+ *****************************************************************************/
+
+//records are copied field by field so the file doesn't depend on struct
+//padding; the machines we run on are all little endian
+template< typename T > static void put(std::vector< char >& bytes, const T& value){
+    const char* first = (const char*)&value;
+    bytes.insert(bytes.end(), first, first + sizeof(T));
+}
+
+//7 bits a byte, low bits first, the top bit set on all but the last byte
+static void put_count(std::vector< char >& bytes, uint64_t value){
+    while(value >= 0x80){
+        bytes.push_back((char)((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((char)value);
+}
+
+//reads stop at end, leaving cursor past it so the record is dropped
+template< typename T > static void get(const char*& cursor, const char* end, T& value){
+    if(end - cursor < (std::ptrdiff_t)sizeof(T)){
+        cursor = end + 1;
+        return;
+    }
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+}
+
+static void get_count(const char*& cursor, const char* end, uint64_t& value){
+    value = 0;
+    for(int shift = 0; shift < 64; shift += 7){
+        if(cursor >= end){
+            cursor = end + 1;
+            return;
+        }
+        uint8_t byte = *cursor++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if(!(byte & 0x80)) return;
+    }
+}
+
+//at most 255 jars, the rest are dropped and true returned
+static bool put_move(std::vector< char >& bytes, const std::vector< int >& move){
+    uint8_t jars = move.size() < 255 ? move.size() : 255;
+    put(bytes, jars);
+    for(int i = 0; i < jars; i++) put(bytes, (uint8_t)move[i]);
+    return jars < move.size();
+}
+
+static void get_move(const char*& cursor, const char* end, std::vector< int >& move){
+    uint8_t jars = 0;
+    get(cursor, end, jars);
+    move.resize(jars);
+    for(int i = 0; i < jars; i++){
+        uint8_t jar = 0;
+        get(cursor, end, jar);
+        move[i] = jar;
+    }
+}
+
+static void encode(const DiagRecord& record, std::vector< char >& bytes){
+    put_count(bytes, record.move_index);
+    put(bytes, record.jars);
+    for(int i = 0; i < record.jars; i++) put(bytes, record.board[i]);
+    put_count(bytes, record.children_generated);
+    put_count(bytes, record.quiescence_nodes);
+    put(bytes, record.seconds);
+    put(bytes, record.heuristic_score);
+    put(bytes, record.budget_hit);
+    //the flags go before the moves, so they are set as the moves are put
+    std::size_t flags = bytes.size();
+    put(bytes, record.truncated);
+    if(put_move(bytes, record.move)) bytes[flags] |= DiagRecord::TRUNCATED_MOVE;
+    uint8_t path_length = record.path.size() < 255 ? record.path.size() : 255;
+    if(path_length < record.path.size()) bytes[flags] |= DiagRecord::TRUNCATED_PATH;
+    put(bytes, path_length);
+    for(int i = 0; i < path_length; i++){
+        if(put_move(bytes, record.path[i])) bytes[flags] |= DiagRecord::TRUNCATED_PATH;
+    }
+}
+
+static bool decode(const char*& cursor, const char* end, DiagRecord& record){
+    uint64_t count = 0;
+    get_count(cursor, end, count);
+    record.move_index = (uint32_t)count;
+    record.jars = 0;
+    get(cursor, end, record.jars);
+    if(record.jars > 14) return false;
+    for(int i = 0; i < 14; i++) record.board[i] = 0;
+    for(int i = 0; i < record.jars; i++) get(cursor, end, record.board[i]);
+    get_count(cursor, end, record.children_generated);
+    get_count(cursor, end, record.quiescence_nodes);
+    get(cursor, end, record.seconds);
+    get(cursor, end, record.heuristic_score);
+    get(cursor, end, record.budget_hit);
+    get(cursor, end, record.truncated);
+    get_move(cursor, end, record.move);
+    uint8_t path_length = 0;
+    get(cursor, end, path_length);
+    record.path.resize(path_length);
+    for(int i = 0; i < path_length; i++) get_move(cursor, end, record.path[i]);
+    return cursor <= end;
+}
+
+//Versions 1 and 2 packed a move 4 bits a jar with 0xf after the last jar,
+//in 64 bits, so a move of 16 jars may have been longer.
+static bool unpack_move(uint64_t packed, std::vector< int >& move){
+    move.clear();
+    for(int i = 0; i < 16; i++){
+        int jar = (int)(packed >> (4 * i)) & 0xf;
+        if(jar == 0xf) return false;
+        move.push_back(jar);
+    }
+    return true;
+}
+
+static void decode_fixed(const char* bytes, uint32_t version, DiagRecord& record){
+    const char* cursor = bytes;
+    const char* end = bytes + RECORD_SIZE_2;
+    uint64_t packed = 0;
+    uint8_t path_length = 0;
+    get(cursor, end, record.move_index);
+    if(version >= 2) get(cursor, end, record.jars);
+    else record.jars = 14;
+    for(int i = 0; i < 14; i++) get(cursor, end, record.board[i]);
+    get(cursor, end, record.children_generated);
+    get(cursor, end, record.quiescence_nodes);
+    get(cursor, end, packed);
+    if(unpack_move(packed, record.move)) record.truncated |= DiagRecord::TRUNCATED_MOVE;
+    get(cursor, end, record.seconds);
+    get(cursor, end, record.heuristic_score);
+    get(cursor, end, record.budget_hit);
+    get(cursor, end, path_length);
+    if(path_length >= PATH_LENGTH_2) record.truncated |= DiagRecord::TRUNCATED_PATH;
+    record.path.resize(path_length < PATH_LENGTH_2 ? path_length : PATH_LENGTH_2);
+    for(int i = 0; i < record.path.size(); i++){
+        get(cursor, end, packed);
+        if(unpack_move(packed, record.path[i])) record.truncated |= DiagRecord::TRUNCATED_PATH;
+    }
+}
+
+DiagLog::DiagLog() : background(false), closing(false){
+}
+
+DiagLog::~DiagLog(){
+    close();
+}
+
+bool DiagLog::open(const std::string& filename, bool background_parameter){
+    file.open(filename.c_str(), std::ios::binary);
+    if(!file.is_open()) return false;
+    background = background_parameter;
+    closing = false;
+    uint32_t record_size = 0; //records vary in size since version 3
+    file.write(MAGIC, sizeof(MAGIC));
+    file.write((const char*)&VERSION, sizeof(VERSION));
+    file.write((const char*)&record_size, sizeof(record_size));
+    buffer.reserve(BLOCK_SIZE);
+    if(background) writer = std::thread(&DiagLog::writer_loop, this);
+    return true;
+}
+
+void DiagLog::write(const DiagRecord& record){
+    encode(record, buffer);
+    if(buffer.size() >= BLOCK_SIZE) hand_off();
+}
+
+void DiagLog::hand_off(){
+    if(buffer.empty()) return;
+    if(!background){
+        file.write(buffer.data(), buffer.size());
+        buffer.clear();
+        return;
+    }
+    //the writer may still be busy with the last block
+    std::unique_lock< std::mutex > guard(lock);
+    changed.wait(guard, [this](){ return pending.empty(); });
+    pending.swap(buffer);
+    changed.notify_all();
+}
+
+void DiagLog::writer_loop(){
+    std::vector< char > block;
+    while(true){
+        {
+            std::unique_lock< std::mutex > guard(lock);
+            changed.wait(guard, [this](){ return !pending.empty() || closing; });
+            if(pending.empty()) return;
+            block.swap(pending);
+            changed.notify_all();
+        }
+        file.write(block.data(), block.size());
+        block.clear();
+    }
+}
+
+void DiagLog::close(){
+    if(!file.is_open()) return;
+    hand_off();
+    if(background){
+        {
+            std::lock_guard< std::mutex > guard(lock);
+            closing = true;
+        }
+        changed.notify_all();
+        writer.join();
+    }
+    file.close();
+}
+
+bool DiagLog::read(const std::string& filename, std::vector< DiagRecord >& records, std::string& error){
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if(!in.is_open()){
+        error = "Can't read " + filename + ".";
+        return false;
+    }
+    char magic[4];
+    uint32_t version, record_size;
+    in.read(magic, sizeof(magic));
+    in.read((char*)&version, sizeof(version));
+    in.read((char*)&record_size, sizeof(record_size));
+    if(!in || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0){
+        error = filename + " is not a binary diag log.";
+        return false;
+    }
+    std::ostringstream message;
+    if(version < 1 || version > VERSION){
+        message << filename << " is a version " << version << " diag log, this build reads versions 1 to " << VERSION
+                << ". Convert it with the build that wrote it, or play the game again with this one.";
+        error = message.str();
+        return false;
+    }
+    if(version == 3){
+        //the whole log at once, as a record's size is only known once read
+        std::vector< char > bytes((std::istreambuf_iterator< char >(in)), std::istreambuf_iterator< char >());
+        const char* cursor = bytes.data();
+        const char* end = cursor + bytes.size();
+        while(cursor < end){
+            DiagRecord record;
+            //a record cut short, by a game that crashed say, ends the log
+            if(!decode(cursor, end, record)) break;
+            records.push_back(record);
+        }
+        return true;
+    }
+    uint32_t expected_size = (version == 1) ? RECORD_SIZE_1 : RECORD_SIZE_2;
+    if(record_size != expected_size){
+        message << filename << " has " << record_size << " byte records, a version " << version << " diag log has "
+                << expected_size << ".";
+        error = message.str();
+        return false;
+    }
+    char bytes[RECORD_SIZE_2];
+    while(in.read(bytes, record_size)){
+        DiagRecord record;
+        decode_fixed(bytes, version, record);
+        records.push_back(record);
+    }
+    return true;
+}
+
+int convert_diag(const std::string& in, const std::string& out){
+    std::vector< DiagRecord > records;
+    std::string error;
+    if(!DiagLog::read(in, records, error)){
+        std::cout << error << std::endl;
+        return 1;
+    }
+    std::ofstream csv(out.c_str());
+    if(!csv.is_open()){
+        std::cout << "Can't write " << out << std::endl;
+        return 1;
+    }
+    write_diag_header(csv);
+    int truncated = 0;
+    for(int i = 0; i < records.size(); i++){
+        write_diag_row(csv, records[i]);
+        if(records[i].truncated) truncated++;
+    }
+    std::cout << records.size() << " moves written to " << out << std::endl;
+    if(truncated > 0){
+        std::cout << truncated << " of them had a move or path longer than the log kept, ended with \"...\""
+                  << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+//
+// Diagnostic output of a game, one record per move, as CSV or as a
+// buffered binary log which can be turned into the same CSV later.
+//
+
+#ifndef TERMINALAPP_DIAGLOG_H
+#define TERMINALAPP_DIAGLOG_H
+#include <vector>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "PlayGame.h"
+
+struct DiagRecord{
+    uint32_t move_index;
+    uint8_t jars; //size of the board, 14 for Kalah(6,6)
+    uint8_t board[14]; //board after the move, its middle and last jars are the scores
+    uint64_t children_generated;
+    uint64_t quiescence_nodes;
+    std::vector< int > move;
+    double seconds; //time to run the search
+    double heuristic_score;
+    uint8_t budget_hit;
+    std::vector< std::vector< int > > path; //the predicted path
+    //set if the log it was read from holds only the start of the move or
+    //of the path; the CSV row ends them with "..."
+    enum{ TRUNCATED_MOVE = 1, TRUNCATED_PATH = 2 };
+    uint8_t truncated;
+
+    DiagRecord() : truncated(0){}
+    //next_move may be of any variant (see Variant.h)
+    template< int PITS, int SEEDS >
+    DiagRecord(int move_index_parameter, const BasicPlayGame< PITS, SEEDS >& next_move, double seconds_parameter){
+        move_index = move_index_parameter;
+        jars = KalahVariant< PITS, SEEDS >::JARS;
+        for(int i = 0; i < 14; i++) board[i] = (i < jars) ? (uint8_t)next_move.next_moves_board[i] : 0;
+        children_generated = next_move.children_generated;
+        quiescence_nodes = next_move.quiescence_nodes;
+        move = next_move.move;
+        seconds = seconds_parameter;
+        heuristic_score = next_move.heuristic_score;
+        budget_hit = next_move.budget_hit;
+        path = next_move.path;
+        truncated = 0;
+    }
+};
+
+//the CSV columns, the same for a game's diag file and a converted log
+void write_diag_header(std::ostream& out);
+void write_diag_row(std::ostream& out, const DiagRecord& record);
+
+//Little endian records behind a short header, written in large blocks.
+//A record holds only the jars of its board and the moves of its path, a
+//byte a jar, with node counts as variable length integers, so most take
+//50 to 80 bytes. A move of more than 255 jars or a path of more than 255
+//moves is cut there and the record marked truncated. With background set
+//the blocks are written by a thread of their own so the searching thread
+//never waits on the disk.
+class DiagLog{
+public:
+    DiagLog();
+    ~DiagLog();
+    bool open(const std::string& filename, bool background);
+    bool is_open() const{ return file.is_open(); }
+    void write(const DiagRecord& record);
+    void close();
+
+    //Reads a log back, of this version or the fixed size records of
+    //versions 1 and 2, which kept 16 jars of a move and 32 moves of the
+    //path: a record filling either is taken as truncated. False with
+    //error set if filename isn't a log this build can read.
+    static bool read(const std::string& filename, std::vector< DiagRecord >& records, std::string& error);
+
+private:
+    void hand_off(); //passes the full buffer on to be written
+    void writer_loop();
+
+    std::ofstream file;
+    std::vector< char > buffer;
+    bool background;
+    std::thread writer;
+    std::mutex lock;
+    std::condition_variable changed;
+    std::vector< char > pending; //block waiting for the writer thread
+    bool closing;
+};
+
+//turns the binary log in into the CSV file out, returns the exit code
+int convert_diag(const std::string& in, const std::string& out);
+
+#endif //TERMINALAPP_DIAGLOG_H
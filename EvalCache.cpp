@@ -0,0 +1,41 @@
+//
+// Cache of heuristic values of leaf boards, which can be shared by
+// searches on many threads.
+//
+
+#include <cstring>
+#include "EvalCache.h"
+
+EvalCache::EvalCache(std::size_t megabytes){
+    std::size_t wanted = megabytes * 1024 * 1024 / sizeof(Slot);
+    entries = 1;
+    while(entries * 2 <= wanted) entries *= 2;
+    slots.reset(new Slot[entries]);
+    mask = entries - 1;
+    clear();
+}
+
+bool EvalCache::probe(uint64_t key, double& value) const{
+    const Slot& slot = slots[(key >> 1) & mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if((check ^ data) != key) return false;
+    std::memcpy(&value, &data, sizeof(value));
+    return true;
+}
+
+void EvalCache::store(uint64_t key, double value){
+    //a newer board always takes the slot
+    Slot& slot = slots[(key >> 1) & mask];
+    uint64_t data;
+    std::memcpy(&data, &value, sizeof(data));
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void EvalCache::clear(){
+    for(std::size_t i = 0; i < entries; i++){
+        slots[i].check.store(0, std::memory_order_relaxed);
+        slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,45 @@
+//
+// Cache of heuristic values of leaf boards, which can be shared by
+// searches on many threads.
+//
+
+#ifndef TERMINALAPP_EVALCACHE_H
+#define TERMINALAPP_EVALCACHE_H
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+//The same leaf board is often reached by moves played in another order.
+//This remembers what calculate_heuristic gave for it, which saves most
+//with Coplin's heuristic as it plays out every move of the board. It is
+//kept apart from the TranspositionTable: it holds plain evaluations, not
+//search bounds, so an entry is good at any depth.
+//
+//Entries are direct mapped and two 64 bit words, the value's bits and
+//the key xor'd with them, written and read without locks like the
+//TranspositionTable's. Keys must have their lowest bit set, so an empty
+//slot never matches, and the slot is picked by the bits above it.
+class EvalCache{
+public:
+    //megabytes is rounded down to a power of two number of entries
+    explicit EvalCache(std::size_t megabytes);
+
+    bool probe(uint64_t key, double& value) const;
+    void store(uint64_t key, double value);
+    void clear();
+
+    std::size_t size() const{ return entries; }
+
+private:
+    struct Slot{
+        std::atomic< uint64_t > check; //key ^ data
+        std::atomic< uint64_t > data;
+    };
+
+    std::unique_ptr< Slot[] > slots;
+    std::size_t entries;
+    std::size_t mask;
+};
+
+#endif //TERMINALAPP_EVALCACHE_H
@@ -0,0 +1,116 @@
+//
+// Experimental board which packs all 14 jars into one 128 bit integer.
+//
+
+#include "PackedBoard.h"
+
+static PackedBoard::Bits byte_mask(int first, int last){
+    PackedBoard::Bits mask = 0;
+    for(int i = first; i <= last; i++) mask |= (PackedBoard::Bits)0xff << (8 * i);
+    return mask;
+}
+
+const PackedBoard::Bits PackedBoard::MAX_SIDE = byte_mask(0, 5);
+const PackedBoard::Bits PackedBoard::MIN_SIDE = byte_mask(7, 12);
+
+//Sowing from a jar walks a cycle of the 13 jars other than the opponent's
+//kalah. For each player and starting jar these tables give:
+//  lap[p][j]       a one in every byte of the cycle, added once per lap
+//  spread[p][j][r] a one in each of the first r jars after j
+//  landing[p][j][r] the jar where stone r + 1 lands
+struct SowTables{
+    PackedBoard::Bits lap[2];
+    PackedBoard::Bits spread[2][14][13];
+    int landing[2][14][13];
+
+    SowTables(){
+        for(int p = 0; p < 2; p++){
+            int skip = p ? 13 : 6; //kalah of the player not moving
+            lap[p] = 0;
+            for(int i = 0; i < 14; i++){
+                if(i != skip) lap[p] |= (PackedBoard::Bits)1 << (8 * i);
+            }
+            for(int j = 0; j < 14; j++){
+                PackedBoard::Bits mask = 0;
+                int cursor = j;
+                spread[p][j][0] = 0;
+                for(int r = 0; r < 13; r++){
+                    cursor = (cursor + 1) % 14;
+                    if(cursor == skip) cursor = (cursor + 1) % 14;
+                    landing[p][j][r] = cursor;
+                    if(r + 1 < 13){
+                        mask |= (PackedBoard::Bits)1 << (8 * cursor);
+                        spread[p][j][r + 1] = mask;
+                    }
+                }
+            }
+        }
+    }
+};
+
+static const SowTables& tables(){
+    static const SowTables sow_tables;
+    return sow_tables;
+}
+
+PackedBoard::PackedBoard(const std::vector< int >& board){
+    bits = 0;
+    for(int i = 0; i < 14; i++) bits |= (Bits)(uint8_t)board[i] << (8 * i);
+}
+
+void PackedBoard::to_vector(std::vector< int >& board) const{
+    board.resize(14);
+    for(int i = 0; i < 14; i++) board[i] = jar(i);
+}
+
+int PackedBoard::sow_jar(bool player_max, int start){
+    const SowTables& sow_tables = tables();
+    int stones = jar(start);
+    if(stones == 0) return 0;
+    bits &= ~((Bits)0xff << (8 * start));
+    int laps = (stones - 1) / 13;
+    int rest = stones - 13 * laps; //1 to 13, the last one is the landing stone
+    bits += sow_tables.lap[player_max] * (Bits)laps;
+    bits += sow_tables.spread[player_max][start][rest - 1];
+    //the landing stone, held back so a capture can take it
+    int landing = sow_tables.landing[player_max][start][rest - 1];
+    int side_marker = 7*!player_max;
+    if(jar(landing) == 0 && landing >= side_marker && landing < 6 + side_marker){
+        int across = 12 - landing;
+        int taken = jar(across);
+        if(taken != 0){
+            bits &= ~((Bits)0xff << (8 * across));
+            bits += (Bits)(taken + 1) << (8 * (6 + side_marker));
+            return taken + 1;
+        }
+    }
+    bits += (Bits)1 << (8 * landing);
+    return 0;
+}
+
+static int byte_sum(uint64_t bytes){
+    //every byte added into the top one, the total never passes 255
+    return (int)((bytes * 0x0101010101010101ULL) >> 56);
+}
+
+void PackedBoard::clear_if_side_empty(){
+    //as in ::sow, the player whose side is empty takes the other side
+    if(max_side_empty()){
+        int seeds = byte_sum((uint64_t)((bits & MIN_SIDE) >> 56));
+        bits &= ~MIN_SIDE;
+        bits += (Bits)seeds << (8 * 6);
+    } else if(min_side_empty()){
+        int seeds = byte_sum((uint64_t)(bits & MAX_SIDE));
+        bits &= ~MAX_SIDE;
+        bits += (Bits)seeds << (8 * 13);
+    }
+}
+
+int PackedBoard::sow(bool player_max, const std::vector< int >& action){
+    int captured = 0;
+    for(int i = 0; i < action.size(); i++){
+        captured += sow_jar(player_max, action[i]);
+    }
+    clear_if_side_empty();
+    return captured;
+}
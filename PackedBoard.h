@@ -0,0 +1,50 @@
+//
+// Experimental board which packs all 14 jars into one 128 bit integer.
+//
+
+#ifndef TERMINALAPP_PACKEDBOARD_H
+#define TERMINALAPP_PACKEDBOARD_H
+#include <vector>
+#include <cstdint>
+
+#ifndef __SIZEOF_INT128__
+#error "PackedBoard needs a compiler with unsigned __int128 (gcc or clang)"
+#endif
+
+//Jar i lives in byte i. No jar holds more than the 72 seeds on the board,
+//so adding to every byte at once never carries into the next jar. This
+//offers the same operations as the std::vector< int > board used by
+//PlayGame (sow, terminal_board) so the two can be compared; building with
+//-DKALAH_PACKED_BOARD makes ::sow go through it.
+class PackedBoard{
+public:
+    typedef unsigned __int128 Bits;
+
+    PackedBoard() : bits(0){}
+    explicit PackedBoard(const std::vector< int >& board);
+    void to_vector(std::vector< int >& board) const;
+
+    int jar(int i) const{ return (int)(uint8_t)(bits >> (8 * i)); }
+
+    //same as ::sow, returns the seeds captured
+    int sow(bool player_max, const std::vector< int >& action);
+    int sow_jar(bool player_max, int jar); //one jar of an action, no end of game clearing
+    void clear_if_side_empty(); //the end of turn rule at the bottom of ::sow
+
+    bool max_side_empty() const{ return (bits & MAX_SIDE) == 0; }
+    bool min_side_empty() const{ return (bits & MIN_SIDE) == 0; }
+    //same as ::terminal_board
+    bool terminal() const{
+        return jar(6) > 36 || jar(13) > 36 || (bits & (MAX_SIDE | MIN_SIDE)) == 0;
+    }
+
+    bool operator==(const PackedBoard& other) const{ return bits == other.bits; }
+
+    static const Bits MAX_SIDE; //bytes 0-5
+    static const Bits MIN_SIDE; //bytes 7-12
+
+private:
+    Bits bits;
+};
+
+#endif //TERMINALAPP_PACKEDBOARD_H
@@ -4,22 +4,81 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include "PlayGame.h"
+#include "Position.h"
+#include "TranspositionTable.h"
+#include "Reductions.h"
+#include "EvalCache.h"
+#ifdef KALAH_PACKED_BOARD
+#include "PackedBoard.h"
+#endif
+
+//Memory counted against options.memory_limit. The node, its board and
+//its result_of_play are three heap blocks, each carrying some allocator
+//overhead, and so is each of its actions.
+static std::size_t node_bytes(const SearchNode& node){
+    return sizeof(SearchNode) + sizeof(std::unique_ptr< SearchNode >) + sizeof(double) + 3 * 16
+           + (node.board.capacity() + node.result_of_play.capacity()) * sizeof(int);
+}
+
+static std::size_t action_bytes(const std::vector< int >& action){
+    return sizeof(std::vector< int >) + 16 + action.capacity() * sizeof(int);
+}
 
-PlayGame::PlayGame(std::vector< int >& board, bool algorithm, bool player, int heuristic, int max_depth_parameter){
-    //    Board: vector of size 14 representing the current board state
+//true once nothing is left to play, a side is empty or a kalah holds
+//more than half of the seeds
+template< class Variant >
+static bool decided_board(const std::vector< int >& board){
+    bool max_empty = true;
+    bool min_empty = true;
+    for(int i = 0; i < Variant::PITS; i++){
+        if(board[i] != 0) max_empty = false;
+        if(board[i + Variant::PITS + 1] != 0) min_empty = false;
+    }
+    return max_empty || min_empty || board[Variant::MAX_KALAH] > Variant::HALF_SEEDS
+           || board[Variant::MIN_KALAH] > Variant::HALF_SEEDS;
+}
+
+template< int PITS, int SEEDS >
+BasicPlayGame< PITS, SEEDS >::BasicPlayGame(std::vector< int >& board, bool algorithm, bool player, int heuristic, int max_depth_parameter)
+    : BasicPlayGame(board, algorithm, player, heuristic, max_depth_parameter, Options()){
+}
+
+template< int PITS, int SEEDS >
+BasicPlayGame< PITS, SEEDS >::BasicPlayGame(std::vector< int >& board, bool algorithm, bool player, int heuristic,
+                                           int max_depth_parameter, const Options& options_parameter){
+    //    Board: vector of size Variant::JARS representing the current board state
     //algorithm: 0 for Rich + Knight, 1 for Norvig and Luger
     //   player: 0 for min's turn, 1 for max's turn
     //heuristic: 0 for alabandi, 1 for bell, 2 for coplin, 3 for score difference
+    //  options: node and memory limits, see PlayGame::Options
     std::unique_ptr< Node > dummy(new Node);
     root = std::move(dummy);
     root->board = board;
     root->depth = 0;
+    root->horizon = max_depth_parameter;
     root->player_max = player;
     root->parent = nullptr;
     function_used = heuristic;
     children_generated = 0;
     max_depth = max_depth_parameter;
+    options = options_parameter;
+    memory_used = sizeof(Node);
+    budget_hit = false;
+    quiescence_nodes = 0;
+    table_probes = 0;
+    table_hits = 0;
+    reduced_searches = 0;
+    re_searches = 0;
+    eval_probes = 0;
+    eval_hits = 0;
+    eval_salt = (uint64_t)(function_used + 2) * 0x9e3779b97f4a7c15ULL ^ weights_hash(options.weights)
+                ^ (uint64_t)(PITS * 8 + SEEDS) * 0xbf58476d1ce4e5b9ULL;
+    pv_plies = max_depth;
+    if(algorithm == 1 && options.reductions != nullptr) pv_plies += std::max(0, options.reductions->max_extension);
+    pv.assign(pv_row(pv_plies + 1), std::vector< int >());
+    pv_length.assign(pv_plies + 2, 0);
 
     //run the game
     if(algorithm == 1) {
@@ -27,32 +86,21 @@ PlayGame::PlayGame(std::vector< int >& board, bool algorithm, bool player, int h
 
         next_moves_board = root->children[root->selected]->board;
         heuristic_score = root->children_value[root->selected];
-        Node* cursor = root->children[root->selected].get();
-        path.push_back(move);
-        while(cursor->action.size() != 0){
-            path.push_back(cursor->action[cursor->selected]);
-            cursor = cursor->children[cursor->selected].get();
-        }
     } else{
         minimax_a_b(*root.get(), 9999999999, -9999999999);
         move = root->action[root->selected];
 
         next_moves_board = root->children[root->selected]->board;
         heuristic_score = root->heuristic_value;
-        Node* cursor = root->children[root->selected].get();
-        path.push_back(move);
-        while(cursor->selected != -1){
-            path.push_back(cursor->action[cursor->selected]);
-            cursor = cursor->children[cursor->selected].get();
-        }
-
     }
+    path.assign(pv.begin(), pv.begin() + pv_length[0]);
 } //the game is run during the constructor.
 
 /******************************************************************************
  *  Alpha-Beta-Search from Russell and Norvig
  *****************************************************************************/
-std::vector< int > PlayGame::alpha_beta_search(Node& state){
+template< int PITS, int SEEDS >
+std::vector< int > BasicPlayGame< PITS, SEEDS >::alpha_beta_search(Node& state){
     double value;
     if(state.player_max){
         value = max_value(*root.get(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max());
@@ -66,59 +114,390 @@ std::vector< int > PlayGame::alpha_beta_search(Node& state){
     }
 }
 
-double PlayGame::max_value(Node& state, double alpha, double beta){
-    if(cutoff_test(state)) return calculate_heuristic(state, function_used);
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::max_value(Node& state, double alpha, double beta){
+    pv_length[state.depth] = 0;
+    if(cutoff_test(state)) return leaf_value(state, alpha, beta);
+    double low, high;
+    outcome_bounds(state, low, high);
+    if(high <= alpha) return high;
+    if(low >= beta) return low;
+    double stored;
+    int best = -1;
+    if(state.depth > 0 && probe_table(state, alpha, beta, stored, best)) return stored;
+    double alpha_start = alpha;
     double value = std::numeric_limits<double>::lowest();
     actions(state);
+    order_actions(state, best);
+    std::vector< double > leaf_values;
+    bool batched = batch_leaves(state, leaf_values);
+    if(batched) pv_length[state.depth + 1] = 0;
     for(int i = 0; i < state.action.size(); i++){
-        generate_child(state, i);
-        double temp_value = min_value(*(state.children[i].get()), alpha, beta);
+        double temp_value = batched ? leaf_values[i] : search_child(state, i, alpha, beta);
+        if(!batched) memory_used -= release_children(*state.children[i].get());
+        //a root child cut short by the budget is not trusted, keep the finished ones
+        if(budget_hit && state.depth == 0 && i > 0) break;
         state.children_value.push_back(temp_value);
         if(value < temp_value){
             value = temp_value;
             state.selected = i;
+            update_pv(state, i);
         }
         if(value >= beta) {
             state.selected = i;
-            return value;
+            break;
         }
         alpha = (alpha > value) ? alpha : value;
+        if(budget_hit) break;
     }
+    if(!budget_hit) store_table(state, alpha_start, beta, value, unordered_index(state.selected, best));
     return value;
 }
 
-double PlayGame::min_value(Node &state, double alpha, double beta) {
-    if (cutoff_test(state)) return calculate_heuristic(state, function_used);
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::min_value(Node &state, double alpha, double beta) {
+    pv_length[state.depth] = 0;
+    if (cutoff_test(state)) return leaf_value(state, alpha, beta);
+    double low, high;
+    outcome_bounds(state, low, high);
+    if (high <= alpha) return high;
+    if (low >= beta) return low;
+    double stored;
+    int best = -1;
+    if (state.depth > 0 && probe_table(state, alpha, beta, stored, best)) return stored;
+    double beta_start = beta;
     double value = std::numeric_limits<double>::max();
     actions(state);
+    order_actions(state, best);
+    std::vector< double > leaf_values;
+    bool batched = batch_leaves(state, leaf_values);
+    if (batched) pv_length[state.depth + 1] = 0;
     for (int i = 0; i < state.action.size(); i++) {
-        generate_child(state, i);
-        double temp_value = max_value(*(state.children[i].get()), alpha, beta);
+        double temp_value = batched ? leaf_values[i] : search_child(state, i, alpha, beta);
+        if (!batched) memory_used -= release_children(*state.children[i].get());
+        //a root child cut short by the budget is not trusted, keep the finished ones
+        if (budget_hit && state.depth == 0 && i > 0) break;
         state.children_value.push_back(temp_value);
         if (value > temp_value){
             value = temp_value;
             state.selected = i;
+            update_pv(state, i);
         }
         if (value <= alpha){
             state.selected = i;
-            return value;
+            break;
         }
         beta = (beta < value) ? beta : value;
+        if (budget_hit) break;
     }
+    if (!budget_hit) store_table(state, alpha, beta_start, value, unordered_index(state.selected, best));
     return value;
 }
 
-bool PlayGame::cutoff_test(Node& state){
-    //checks if the state has reached max_depth
-    //or if state's board is an ended game
-    if(state.depth == max_depth) return true;
-    bool player_one_empty = true;
-    bool player_two_empty = true;
-    for(int i = 0; i < 6; i++){
-        if(state.board[i] != 0) player_one_empty = false;
-        if(state.board[i + 7] != 0) player_two_empty = false;
+template< int PITS, int SEEDS >
+bool BasicPlayGame< PITS, SEEDS >::cutoff_test(Node& state){
+    //checks if the state has reached its horizon (max_depth unless
+    //reduced or extended) or if state's board is an ended game
+    if(state.depth >= state.horizon) return true;
+    return decided_board< Variant >(state.board);
+}
+
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::search_child(Node& state, int i, double alpha, double beta){
+    //Late move reductions: moves ordered late are rarely the best, so a
+    //quiet one (a single jar capturing nothing) is first searched a few
+    //plies short. Only if that says it beats the best move so far is it
+    //searched again to its full horizon.
+    generate_child(state, i);
+    Node& child = *state.children[i].get();
+    if(options.reductions == nullptr) return child.player_max ? max_value(child, alpha, beta) : min_value(child, alpha, beta);
+    int added = extension(state, child);
+    child.horizon += added;
+    int reduction = 0;
+    if(added == 0 && child.result_of_play.size() == 1 && child.captured == 0){
+        reduction = options.reductions->reduction(state.horizon - state.depth, i);
+        //always leave a ply to search below child
+        reduction = std::max(0, std::min(reduction, child.horizon - child.depth - 1));
     }
-    return player_one_empty || player_two_empty;
+    if(reduction == 0) return child.player_max ? max_value(child, alpha, beta) : min_value(child, alpha, beta);
+
+    reduced_searches++;
+    child.horizon -= reduction;
+    double value = child.player_max ? max_value(child, alpha, beta) : min_value(child, alpha, beta);
+    bool beats_bound = state.player_max ? value > alpha : value < beta;
+    if(!beats_bound || budget_hit) return value;
+    re_searches++;
+    //start child over
+    child.horizon += reduction;
+    memory_used -= release_children(child);
+    child.selected = 0;
+    return child.player_max ? max_value(child, alpha, beta) : min_value(child, alpha, beta);
+}
+
+template< int PITS, int SEEDS >
+int BasicPlayGame< PITS, SEEDS >::extension(Node& state, Node& child){
+    //Forcing lines are looked at further: a node with only one move, and
+    //a long chain of extra turns which ends in a capture. No line goes
+    //more than max_extension plies past max_depth.
+    const Reductions& reductions = *options.reductions;
+    int added = 0;
+    if(state.action.size() == 1) added += reductions.single_reply;
+    if(child.result_of_play.size() >= reductions.chain_length && child.captured > 0) added += reductions.capture_chain;
+    int room = max_depth + reductions.max_extension - child.horizon;
+    return std::max(0, std::min(added, room));
+}
+
+/******************************************************************************
+ *  Leaf evaluation and quiescence
+ *****************************************************************************/
+
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::leaf_value(Node& state, double alpha, double beta){
+    //Only positions cut off by depth are extended, an ended game has
+    //nothing left to play out.
+    if(options.quiescence_node_limit > 0 && state.depth >= state.horizon && !terminal_board(state.board)){
+        return quiescence(state, alpha, beta);
+    }
+    return static_value(state);
+}
+
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::static_value(Node& state){
+    if(decided_board< Variant >(state.board)) return exact_score(state.board, state.depth);
+    return bounded_value(state, cached_heuristic(state));
+}
+
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::bounded_value(Node& state, double value){
+    //a player holding half of the seeds can do no worse than a draw
+    if(state.board[Variant::MIN_KALAH] >= Variant::HALF_SEEDS && value > 0) value = 0;
+    if(state.board[Variant::MAX_KALAH] >= Variant::HALF_SEEDS && value < 0) value = 0;
+    return value;
+}
+
+template< int PITS, int SEEDS >
+bool BasicPlayGame< PITS, SEEDS >::batch_leaves(Node& state, std::vector< double >& values){
+    //When every child of state is a leaf they are all made up front and
+    //scored in one go by evaluate_batch. values[i] is then what
+    //leaf_value would give child i. The batches are laid out for Kalah(6,6).
+    if(!options.batch_leaves || Variant::JARS != 14 || state.depth + 1 != state.horizon || options.quiescence_node_limit > 0
+       || options.reductions != nullptr || !batch_heuristic(function_used)) return false;
+    leaf_batch.clear(!state.player_max);
+    for(int i = 0; i < state.action.size(); i++){
+        if(i >= state.children.size()) result(state, state.action[i]);
+        leaf_batch.add(state.children[i]->board);
+    }
+    evaluate_batch(leaf_batch, function_used, options.weights, values);
+    for(int i = 0; i < state.action.size(); i++){
+        Node& child = *state.children[i].get();
+        if(decided_board< Variant >(child.board)) values[i] = exact_score(child.board, child.depth);
+        else values[i] = bounded_value(child, values[i]);
+    }
+    return true;
+}
+
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::outcome_bounds(Node& state, double& low, double& high){
+    //No game can end before the next ply, so nothing below state does
+    //better than the quickest possible win. The seed count narrows this
+    //further: a player holding half of the seeds in play can't lose.
+    high = WIN_SCORE - (state.depth + 1);
+    low = -high;
+    if(state.board[Variant::MIN_KALAH] >= Variant::HALF_SEEDS) high = 0;
+    if(state.board[Variant::MAX_KALAH] >= Variant::HALF_SEEDS) low = 0;
+}
+
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::exact_score(const std::vector< int >& board, int depth){
+    //seeds left on a side go to the kalah of the player whose side is
+    //empty, as in sow
+    int max_kalah = board[Variant::MAX_KALAH];
+    int min_kalah = board[Variant::MIN_KALAH];
+    bool max_empty = true;
+    bool min_empty = true;
+    for(int i = 0; i < PITS; i++){
+        if(board[i] != 0) max_empty = false;
+        if(board[i + PITS + 1] != 0) min_empty = false;
+    }
+    if(max_empty){
+        for(int i = PITS + 1; i < Variant::MIN_KALAH; i++) max_kalah += board[i];
+    } else if(min_empty){
+        for(int i = 0; i < PITS; i++) min_kalah += board[i];
+    }
+    if(max_kalah > Variant::HALF_SEEDS || (max_kalah > min_kalah && (max_empty || min_empty))) return WIN_SCORE - depth;
+    if(min_kalah > Variant::HALF_SEEDS || (min_kalah > max_kalah && (max_empty || min_empty))) return -(WIN_SCORE - depth);
+    return 0;
+}
+
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::quiescence(Node& state, double alpha, double beta){
+    //The side to move may stand pat on the heuristic or play one of its
+    //noisy moves, being a capture or a chain that earned extra turns.
+    //Quiet moves are not searched, so this ends once the position is quiet
+    //or the quiescence node limit is used up.
+    double value = static_value(state);
+    if(quiescence_nodes >= options.quiescence_node_limit || terminal_board(state.board)) return value;
+    if(state.player_max){
+        if(value >= beta) return value;
+        alpha = (alpha > value) ? alpha : value;
+    } else{
+        if(value <= alpha) return value;
+        beta = (beta < value) ? beta : value;
+    }
+
+    //the scratch node keeps these moves out of the tree and its memory count
+    Node scratch;
+    scratch.board = state.board;
+    scratch.player_max = state.player_max;
+    legal_actions(scratch);
+    for(int i = 0; i < scratch.action.size(); i++){
+        Node child;
+        child.board = state.board;
+        int captured = sow(child.board, state.player_max, scratch.action[i]);
+        if(captured == 0 && scratch.action[i].size() == 1) continue;
+        if(quiescence_nodes >= options.quiescence_node_limit) break;
+        quiescence_nodes++;
+        child.player_max = !state.player_max;
+        child.depth = state.depth + 1;
+        double temp_value = quiescence(child, alpha, beta);
+        if(state.player_max){
+            if(value < temp_value) value = temp_value;
+            if(value >= beta) return value;
+            alpha = (alpha > value) ? alpha : value;
+        } else{
+            if(value > temp_value) value = temp_value;
+            if(value <= alpha) return value;
+            beta = (beta < value) ? beta : value;
+        }
+    }
+    return value;
+}
+
+/******************************************************************************
+ *  Transposition table
+ *****************************************************************************/
+
+//Wins are scored from the root (see WIN_SCORE) but a stored position can be
+//met again at another depth, so the table holds them relative to the node.
+static double win_to_table(double value, int depth){
+    if(value > WIN_SCORE / 2) return value + depth;
+    if(value < -WIN_SCORE / 2) return value - depth;
+    return value;
+}
+
+static double win_from_table(double value, int depth){
+    if(value > WIN_SCORE / 2) return value - depth;
+    if(value < -WIN_SCORE / 2) return value + depth;
+    return value;
+}
+
+template< int PITS, int SEEDS >
+uint64_t BasicPlayGame< PITS, SEEDS >::table_key(Node& state, bool& mirrored){
+    //values depend on the heuristic, its weights and on quiescence being used, so
+    //those are part of the key and searches of any kind can share a table
+    PositionKey key = position_key(state.board, state.player_max, search_symmetry(function_used));
+    mirrored = key.mirrored;
+    uint64_t salt = (uint64_t)(function_used + 2) * 0x9e3779b97f4a7c15ULL;
+    if(options.quiescence_node_limit > 0) salt ^= 0xd1b54a32d192ed03ULL;
+    salt ^= weights_hash(options.weights);
+    return key.hash ^ salt;
+}
+
+template< int PITS, int SEEDS >
+bool BasicPlayGame< PITS, SEEDS >::probe_table(Node& state, double alpha, double beta, double& value, int& best){
+    if(options.table == nullptr) return false;
+    table_probes++;
+    bool mirrored;
+    TranspositionTable::Entry entry;
+    if(!options.table->probe(table_key(state, mirrored), entry)) return false;
+    table_hits++;
+    best = entry.best;
+    if(entry.depth < state.horizon - state.depth) return false;
+    //a mirrored entry is stored from the other player's side
+    value = win_from_table(mirrored ? -entry.value : entry.value, state.depth);
+    TranspositionTable::Bound bound = entry.bound;
+    if(mirrored && bound != TranspositionTable::EXACT){
+        bound = (bound == TranspositionTable::LOWER) ? TranspositionTable::UPPER : TranspositionTable::LOWER;
+    }
+    if(bound == TranspositionTable::EXACT) return true;
+    if(bound == TranspositionTable::LOWER && value >= beta) return true;
+    if(bound == TranspositionTable::UPPER && value <= alpha) return true;
+    return false;
+}
+
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::store_table(Node& state, double alpha, double beta, double value, int best){
+    if(options.table == nullptr) return;
+    bool mirrored;
+    uint64_t key = table_key(state, mirrored);
+    TranspositionTable::Entry entry;
+    entry.bound = TranspositionTable::EXACT;
+    if(value <= alpha) entry.bound = TranspositionTable::UPPER;
+    else if(value >= beta) entry.bound = TranspositionTable::LOWER;
+    if(mirrored && entry.bound != TranspositionTable::EXACT){
+        entry.bound = (entry.bound == TranspositionTable::LOWER) ? TranspositionTable::UPPER : TranspositionTable::LOWER;
+    }
+    value = win_to_table(value, state.depth);
+    entry.value = mirrored ? -value : value;
+    entry.depth = state.horizon - state.depth;
+    entry.best = best;
+    options.table->store(key, entry);
+}
+
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::order_actions(Node& state, int& best){
+    //the stored best action is tried first, the rest keep their order
+    //best is reset to -1 when it doesn't fit this node
+    if(best >= (int)state.action.size()) best = -1;
+    if(best <= 0) return;
+    std::rotate(state.action.begin(), state.action.begin() + best, state.action.begin() + best + 1);
+}
+
+int unordered_index(int i, int best){
+    //undoes order_actions, giving the index actions() produced
+    if(best <= 0) return i;
+    if(i == 0) return best;
+    if(i <= best) return i - 1;
+    return i;
+}
+
+/******************************************************************************
+ *  Principal variation
+ *****************************************************************************/
+
+template< int PITS, int SEEDS >
+std::size_t BasicPlayGame< PITS, SEEDS >::pv_row(int depth){
+    //row d has room for the pv_plies - d moves left below depth d
+    return (std::size_t)depth * pv_plies - (std::size_t)depth * (depth - 1) / 2;
+}
+
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::update_pv(Node& state, int i){
+    //The child has just been searched, so row depth + 1 holds its line.
+    //Assigning into the rows reuses their storage, so once the search
+    //is under way this rarely allocates.
+    std::size_t row = pv_row(state.depth);
+    std::size_t below = pv_row(state.depth + 1);
+    int length = pv_length[state.depth + 1];
+    pv[row] = state.action[i];
+    for(int j = 0; j < length; j++) pv[row + 1 + j] = pv[below + j];
+    pv_length[state.depth] = length + 1;
+}
+
+template< int PITS, int SEEDS >
+std::size_t BasicPlayGame< PITS, SEEDS >::release_children(Node& state){
+    //Nothing below a searched node is looked at again: its value is in
+    //the parent and its line in pv.
+    std::size_t freed = 0;
+    for(int i = 0; i < state.children.size(); i++){
+        Node& child = *state.children[i].get();
+        freed += release_children(child) + node_bytes(child);
+    }
+    for(int i = 0; i < state.action.size(); i++) freed += action_bytes(state.action[i]);
+    std::vector< std::unique_ptr< Node >>().swap(state.children);
+    std::vector< double >().swap(state.children_value);
+    std::vector< std::vector< int >>().swap(state.action);
+    return freed;
 }
 
 /******************************************************************************
@@ -133,39 +512,75 @@ bool PlayGame::cutoff_test(Node& state){
 // value is node.heuristic_value
 // path is created via following a path in the constructor
 
-void PlayGame::minimax_a_b(Node& node, double use_thresh, double pass_thresh){
-    if(node.depth == max_depth || terminal_board(node.board)){
-        node.heuristic_value = calculate_heuristic(node, function_used);
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::minimax_a_b(Node& node, double use_thresh, double pass_thresh){
+    pv_length[node.depth] = 0;
+    if(node.depth >= node.horizon || terminal_board(node.board)){
+        //leaf_value works from max's side, so turn the thresholds around for min
+        if(node.player_max) node.heuristic_value = leaf_value(node, pass_thresh, use_thresh);
+        else node.heuristic_value = leaf_value(node, -1 * use_thresh, -1 * pass_thresh);
         //to correct for heuristic style
         if(!node.player_max) node.heuristic_value *= -1;
         node.selected = -1;
         return;
     }
+    //stop if the reachable outcomes can't change the thresholds
+    double low, high;
+    outcome_bounds(node, low, high);
+    if(!node.player_max){
+        double temp = low;
+        low = -1 * high;
+        high = -1 * temp;
+    }
+    if(high <= pass_thresh || low >= use_thresh){
+        node.heuristic_value = (high <= pass_thresh) ? high : low;
+        node.selected = -1;
+        return;
+    }
     //generate successors
     actions(node);
     generate_children(node);
+    std::vector< double > leaf_values;
+    bool batched = batch_leaves(node, leaf_values);
+    if(batched) pv_length[node.depth + 1] = 0;
     for(int i = 0; i < node.children.size(); i++){
         Node* result_succ = node.children[i].get();
-        minimax_a_b(*result_succ, -1 * pass_thresh, -1 * use_thresh);
+        if(batched){
+            //as the leaf case above would have set it
+            result_succ->heuristic_value = result_succ->player_max ? leaf_values[i] : -1 * leaf_values[i];
+            result_succ->selected = -1;
+        } else{
+            minimax_a_b(*result_succ, -1 * pass_thresh, -1 * use_thresh);
+            memory_used -= release_children(*result_succ);
+        }
+        //a root child cut short by the budget is not trusted, keep the finished ones
+        if(budget_hit && node.depth == 0 && i > 0) break;
+        //selected starts at 0, so the line runs through the first child
+        //until another beats it
+        if(i == 0) update_pv(node, 0);
         double new_value = -1*result_succ->heuristic_value;
         if(new_value > pass_thresh){
             pass_thresh = new_value;
             node.selected = i;
+            update_pv(node, i);
         }
         if(pass_thresh >= use_thresh){
             node.heuristic_value = pass_thresh;
             node.selected = i;
             return;
         }
+        if(budget_hit) break;
     }
     node.heuristic_value = pass_thresh;
     return;
 }
 
-bool terminal_board(std::vector< int > board){
-    for(int i = 0; i < 6; i++){
+template< int PITS, int SEEDS >
+bool BasicPlayGame< PITS, SEEDS >::terminal_board(const std::vector< int >& board){
+    if(board[Variant::MAX_KALAH] > Variant::HALF_SEEDS || board[Variant::MIN_KALAH] > Variant::HALF_SEEDS) return true;
+    for(int i = 0; i < PITS; i++){
         if(board[i] != 0) return false;
-        if(board[12 - i] != 0) return false;
+        if(board[2 * PITS - i] != 0) return false;
     }
     return true;
 }
@@ -174,17 +589,26 @@ bool terminal_board(std::vector< int > board){
  *  Tree Functions
  *****************************************************************************/
 
-void PlayGame::generate_children(Node& state){
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::generate_children(Node& state){
     for(int i = 0; i < state.action.size(); i++){
         result(state, state.action[i]);
     }
 }
 
-void PlayGame::generate_child(Node& state, int i){
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::generate_child(Node& state, int i){
     result(state, state.action[i]);
 }
 
-void PlayGame::actions(Node& state){
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::actions(Node& state){
+    legal_actions(state);
+    for(int i = 0; i < state.action.size(); i++) memory_used += action_bytes(state.action[i]);
+}
+
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::legal_actions(Node& state){
     /*We need to find all possible moves that a player can make. This
       is more than 6 as it is possible to move more than once in a single
       turn. Each one of these can be represented by a chain of moves which
@@ -193,14 +617,14 @@ void PlayGame::actions(Node& state){
 
     //look at board from player's perspective
     std::vector< int > half_board;
-    for(int i = 0; i < 6; i++){
-        half_board.push_back(state.board[i + 7*!state.player_max]);
+    for(int i = 0; i < PITS; i++){
+        half_board.push_back(state.board[i + Variant::side(state.player_max)]);
     }
-    for(int i = 0; i < 6; i++){
+    for(int i = 0; i < PITS; i++){
         if(half_board[i] != 0){
             std::vector< int > current_action;
             current_action.push_back(i);
-            if(half_board[i] + i == 6){
+            if(half_board[i] + i == PITS){
                 actions_move_again(state, half_board, current_action);
                 continue;
             }
@@ -208,20 +632,18 @@ void PlayGame::actions(Node& state){
         }
     }
     //because we only looked at the board on a single side, all moves will
-    //be recorded as an integer from 0 to 5. This takes care of that.
+    //be recorded as an integer from 0 to PITS - 1. This takes care of that.
     if(!state.player_max) {
         for (int i = 0; i < state.action.size(); i++) {
             for (int j = 0; j < state.action[i].size(); j++) {
-                state.action[i][j]+=7;
+                state.action[i][j]+=PITS + 1;
             }
         }
     }
 }
 
-//Simple function for finding the jar across board
-int across(int jar){ return 12 - jar; }
-
-PlayGame::Node* PlayGame::result(Node& state, std::vector< int > action){
+template< int PITS, int SEEDS >
+SearchNode* BasicPlayGame< PITS, SEEDS >::result(Node& state, std::vector< int > action){
     //This is what generates children. This takes a state and an action
     //and creates a new_state as a child of the given state based upon
     //the action taken.
@@ -231,75 +653,105 @@ PlayGame::Node* PlayGame::result(Node& state, std::vector< int > action){
     new_state->parent = &state;
     new_state->player_max = !state.player_max;
     new_state->depth = state.depth + 1;
-    int side_marker = 7*!new_state->player_max;
+    new_state->horizon = state.horizon;
     //copy the board
-    for(int i = 0; i < 14; i++){
+    for(int i = 0; i < Variant::JARS; i++){
         new_state->board.push_back(state.board[i]);
     }
-    //apply the action
+    //add our result_of_play values for reference later
     for(int i = 0; i < action.size(); i++){
-        //add our result_of_play values for reference later
         new_state->result_of_play.push_back(action[i]);
+    }
+    //apply the action
+    new_state->captured = sow(new_state->board, state.player_max, action);
+    memory_used += node_bytes(*new_state);
+    check_budget();
+    Node* return_state = new_state.get();
+    state.children.push_back(std::move(new_state));
+    return return_state;
+}
+
+template< int PITS, int SEEDS >
+int BasicPlayGame< PITS, SEEDS >::sow(std::vector< int >& board, bool player_max, const std::vector< int >& action){
+    //Plays a whole turn (every jar of the action) for the given player.
+    //Returns the number of seeds taken by captures, the capturing stone
+    //included, so callers can tell a capture from a quiet move.
+#ifdef KALAH_PACKED_BOARD
+    if(Variant::JARS == 14){
+        PackedBoard packed(board);
+        int packed_captured = packed.sow(player_max, action);
+        packed.to_vector(board);
+        return packed_captured;
+    }
+#endif
+    const typename Variant::Tables& tables = Variant::tables;
+    const int* next = tables.next[player_max]; //skips the opponent's kalah
+    int side_marker = Variant::side(player_max); //first jar of the player moving
+    int captured = 0;
+    for(int i = 0; i < action.size(); i++){
         //pick up our stones from jar
-        int stones = new_state->board[action[i]];
-        new_state->board[action[i]] = 0;
-        int cursor = action[i] + 1;
-        //play the stones from jar
-        while(stones > 0){
-            //note we can ignore the case where we end in our own kalah
-            //This is handled by the actions function
-            if(cursor == (6 + side_marker)){
-                //if the next space is the opponent's kalah
-                cursor++;
-                cursor%=14;
-            } else if(stones == 1) {
-                //last stone
-                if(new_state->board[cursor] == 0 && new_state->board[across(cursor)] != 0
-                   && cursor > side_marker && cursor < 6 + side_marker){
-                    //if we are ending in an empty jar on our side and our opponent
-                    //jar across the board isn't empty
-                    new_state->board[6 + side_marker]+=new_state->board[across(cursor)];
-                    new_state->board[6 + side_marker]++;
-                    stones--;
-                }
-                new_state->board[cursor]++;
-                stones--;
-            } else {
-                new_state->board[cursor]++;
-                stones--;
-                cursor++;
-                cursor%=14;
-            }
-        }// while loop
+        int stones = board[action[i]];
+        if(stones == 0) continue;
+        board[action[i]] = 0;
+        int cursor = action[i];
+        //play all but the last stone
+        while(stones > 1){
+            cursor = next[cursor];
+            board[cursor]++;
+            stones--;
+        }
+        //last stone, note we can ignore the case where we end in our own
+        //kalah. This is handled by the actions function
+        cursor = next[cursor];
+        int opposite = tables.across[cursor];
+        if(board[cursor] == 0 && board[opposite] != 0
+           && cursor >= side_marker && cursor < PITS + side_marker){
+            //if we are ending in an empty jar on our side and our opponent
+            //jar across the board isn't empty, both go to our kalah
+            captured += board[opposite] + 1;
+            board[Variant::kalah(player_max)] += board[opposite] + 1;
+            board[opposite] = 0;
+        } else{
+            board[cursor]++;
+        }
     }// for loop
     //check to see if a board side is cleared and apply the board clear if so
     bool player_one_empty = true;
     bool player_two_empty = true;
-    for(int i = 0; i < 6; i++){
-        if(new_state->board[i] != 0) player_one_empty = false;
-        if(new_state->board[i + 7] != 0) player_two_empty = false;
+    for(int i = 0; i < PITS; i++){
+        if(board[i] != 0) player_one_empty = false;
+        if(board[i + PITS + 1] != 0) player_two_empty = false;
     }
     if(player_one_empty){
-        for(int i = 7; i < 13; i++){
-            new_state->board[6]+=new_state->board[i];
-            new_state->board[i] = 0;
+        for(int i = PITS + 1; i < Variant::MIN_KALAH; i++){
+            board[Variant::MAX_KALAH]+=board[i];
+            board[i] = 0;
         }
     } else if(player_two_empty){
-        for(int i = 0; i < 6; i++){
-            new_state->board[13]+=new_state->board[i];
-            new_state->board[i] = 0;
+        for(int i = 0; i < PITS; i++){
+            board[Variant::MIN_KALAH]+=board[i];
+            board[i] = 0;
         }
     }
-    Node* return_state = new_state.get();
-    state.children.push_back(std::move(new_state));
-    return return_state;
+    return captured;
+}
+
+template< int PITS, int SEEDS >
+std::vector< int > BasicPlayGame< PITS, SEEDS >::starting_board(){
+    std::vector< int > board;
+    for(int i = 0; i < Variant::JARS; i++){
+        if(i%(PITS + 1) == PITS) board.push_back(0);
+        else board.push_back(SEEDS);
+    }
+    return board;
 }
 
-void PlayGame::actions_move_again(Node& state, std::vector< int > half_board, std::vector< int > current_action){
-    //Helper function for void PlayGame::actions( . . . );
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::actions_move_again(Node& state, std::vector< int > half_board, std::vector< int > current_action){
+    //Helper function for void BasicPlayGame::actions( . . . );
     half_board[current_action.back()] = 0;
     bool populated_board = false;
-    for(int i = 0; i < 6; i++){
+    for(int i = 0; i < PITS; i++){
         if(half_board[i] != 0){
             populated_board = true;
             break;
@@ -310,17 +762,17 @@ void PlayGame::actions_move_again(Node& state, std::vector< int > half_board, st
         return;
     }
 
-    for(int i = current_action.back() + 1; i < 6; i++){
+    for(int i = current_action.back() + 1; i < PITS; i++){
         half_board[i]++;
     }
-    for(int i = 0; i < 6; i++){
+    for(int i = 0; i < PITS; i++){
         if(half_board[i] != 0){
             std::vector< int > current_subaction;
             for(int j = 0; j < current_action.size(); j++){
                 current_subaction.push_back(current_action[j]);
             }
             current_subaction.push_back(i);
-            if(half_board[i] + i == 6){
+            if(half_board[i] + i == PITS){
                 actions_move_again(state, half_board, current_subaction);
                 continue;
             }
@@ -333,7 +785,8 @@ void PlayGame::actions_move_again(Node& state, std::vector< int > half_board, st
 /  Heuristics and their helper functions
 /*****************************************************************************/
 
-double PlayGame::calculate_heuristic(Node& current_board, int selection){
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::calculate_heuristic(Node& current_board, int selection){
     if(selection == 0){
         return alabandi_heuristic(current_board);
     }
@@ -346,7 +799,29 @@ double PlayGame::calculate_heuristic(Node& current_board, int selection){
     return simple_heuristic(current_board);
 }
 
-static double scoreOpMove(std::vector<int> &board, int move, bool player1) {
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::cached_heuristic(Node& state){
+    if(options.eval_cache == nullptr) return calculate_heuristic(state, function_used);
+    //The heuristics read the side to move, so it is part of the key. As
+    //in the transposition table a board and its mirror share the
+    //canonical key, here whenever the heuristic maps one's value onto the
+    //other's, which also holds for Alabandi's and Coplin's.
+    int symmetry = heuristic_symmetry(function_used);
+    PositionKey position = position_key(state.board, state.player_max, symmetry);
+    uint64_t key = (position.hash ^ eval_salt) | 1;
+    double value;
+    eval_probes++;
+    if(options.eval_cache->probe(key, value)){
+        eval_hits++;
+        return from_canonical(value, position, symmetry);
+    }
+    value = calculate_heuristic(state, function_used);
+    options.eval_cache->store(key, to_canonical(value, position, symmetry));
+    return value;
+}
+
+template< class Variant >
+static double scoreOpMove(std::vector<int> &board, int move, bool player1, const Weights& weights) {
     int marbles = board[move];
     int curr = move + 1;
     double scores = 0;
@@ -358,34 +833,21 @@ static double scoreOpMove(std::vector<int> &board, int move, bool player1) {
 
     if (player1) {
         while (marbles != 0) {
-            if (curr != 13) { //don't put anything in opponents store
-                if (curr < 6) {
+            if (curr != Variant::MIN_KALAH) { //don't put anything in opponents store
+                if (curr < Variant::PITS) {
                     //test for capture
                     if (marbles == 1 && temp_board[curr] == 0) {
                         scores++; //store the last marble
 
                         //store the opposing opponent pot
-                        switch(curr) {
-                            case 0: scores += temp_board[12];
-                                break;
-                            case 1: scores += temp_board[11];
-                                break;
-                            case 2: scores += temp_board[10];
-                                break;
-                            case 3: scores += temp_board[9];
-                                break;
-                            case 4: scores += temp_board[8];
-                                break;
-                            case 5: scores += temp_board[7];
-                                break;
-                        }
+                        scores += temp_board[Variant::tables.across[curr]];
                     }
                     else {
                         //not a capture, but still our own pot
                         scores++;
                     }
                 }
-                else if (curr == 6) {
+                else if (curr == Variant::MAX_KALAH) {
                     //scoring pot
                     scores++;
 
@@ -394,25 +856,25 @@ static double scoreOpMove(std::vector<int> &board, int move, bool player1) {
                         multiMove = true;
                     }
                 }
-                else if (curr > 6) {
+                else if (curr > Variant::MAX_KALAH) {
                     //opponents pot
                     overflows++;
                 }
             }
-            curr = (curr + 1) % 14;
+            curr = (curr + 1) % Variant::JARS;
             marbles--;
         }
 
         if (multiMove) {
-            scores *= 1.5;
+            scores *= weights.multi_move;
         }
 
-        return (scores - ((overflows * 0.3) * (overflows * 0.3)));
+        return (scores - ((overflows * weights.overflow) * (overflows * weights.overflow)));
     }
     else { //player2
         while (marbles != 0) {
-            if (curr != 6) { //don't put anything in opponents store
-                if (curr == 13) {
+            if (curr != Variant::MAX_KALAH) { //don't put anything in opponents store
+                if (curr == Variant::MIN_KALAH) {
                     //scoring pot
                     scores++;
 
@@ -421,50 +883,38 @@ static double scoreOpMove(std::vector<int> &board, int move, bool player1) {
                         multiMove = true;
                     }
                 }
-                else if (curr > 6) {
+                else if (curr > Variant::MAX_KALAH) {
                     //test for capture
                     if (marbles == 1 && temp_board[curr] == 0) {
                         scores++; //store the last marble
 
                         //store the opposing opponent pot
-                        switch(curr) {
-                            case 7: scores += temp_board[5];
-                                break;
-                            case 8: scores += temp_board[4];
-                                break;
-                            case 9: scores += temp_board[3];
-                                break;
-                            case 10: scores += temp_board[2];
-                                break;
-                            case 11: scores += temp_board[1];
-                                break;
-                            case 12: scores += temp_board[0];
-                                break;
-                        }
+                        scores += temp_board[Variant::tables.across[curr]];
                     }
                     else {
                         //not a capture, but still our own pot
                         scores++;
                     }
                 }
-                else if (curr < 6) {
+                else if (curr < Variant::PITS) {
                     //opponents pot
                     overflows++;
                 }
             }
-            curr = (curr + 1) % 14;
+            curr = (curr + 1) % Variant::JARS;
             marbles--;
         }
 
         if (multiMove) {
-            scores *= 1.5;
+            scores *= weights.multi_move;
         }
 
-        return (scores - ((overflows * 0.3) * (overflows * 0.3)));
+        return (scores - ((overflows * weights.overflow) * (overflows * weights.overflow)));
     }
 }
 
-double scoreMove(std::vector<int> &board, int move, bool player1) {
+template< class Variant >
+static double scoreMove(std::vector<int> &board, int move, bool player1, const Weights& weights) {
     int marbles = board[move];
     int curr = move + 1;
     double scores = 0;
@@ -478,40 +928,21 @@ double scoreMove(std::vector<int> &board, int move, bool player1) {
 
     if (player1) {
         while (marbles != 0) {
-            if (curr != 13) { //don't put anything in opponents store
-                if (curr < 6) {
+            if (curr != Variant::MIN_KALAH) { //don't put anything in opponents store
+                if (curr < Variant::PITS) {
                     //test for capture
                     if (marbles == 1 && temp_board[curr] == 0) {
                         scores++; //store the last marble
 
                         //store the opposing opponent pot
-                        switch(curr) {
-                            case 0: scores += temp_board[12];
-                                temp_board[12] == 0;
-                                break;
-                            case 1: scores += temp_board[11];
-                                temp_board[11] == 0;
-                                break;
-                            case 2: scores += temp_board[10];
-                                temp_board[10] == 0;
-                                break;
-                            case 3: scores += temp_board[9];
-                                temp_board[9] == 0;
-                                break;
-                            case 4: scores += temp_board[8];
-                                temp_board[8] == 0;
-                                break;
-                            case 5: scores += temp_board[7];
-                                temp_board[7] == 0;
-                                break;
-                        }
+                        scores += temp_board[Variant::tables.across[curr]];
                     }
                     else {
                         //not a capture, but still our own pot
                         scores++;
                     }
                 }
-                else if (curr == 6) {
+                else if (curr == Variant::MAX_KALAH) {
                     //scoring pot
                     scores++;
 
@@ -520,26 +951,26 @@ double scoreMove(std::vector<int> &board, int move, bool player1) {
                         multiMove = true;
                     }
                 }
-                else if (curr > 6) {
+                else if (curr > Variant::MAX_KALAH) {
                     //opponents pot
                     overflows++;
                 }
             }
-            curr = (curr + 1) % 14;
+            curr = (curr + 1) % Variant::JARS;
             marbles--;
         }
 
         if (multiMove) {
-            scores *= 1.5;
+            scores *= weights.multi_move;
         }
 
-        moveScore = scores - ((overflows * 0.3) * (overflows * 0.3));
+        moveScore = scores - ((overflows * weights.overflow) * (overflows * weights.overflow));
 
         //score how this move sets up the opponent
         double maxOpScore = 0;
-        for (int i = 7; i < 13; ++i) {
+        for (int i = Variant::PITS + 1; i < Variant::MIN_KALAH; ++i) {
             //score this move
-            opScore = scoreOpMove(temp_board, i, false);
+            opScore = scoreOpMove< Variant >(temp_board, i, false, weights);
 
             if (opScore > maxOpScore) {
                 maxOpScore = opScore;
@@ -554,8 +985,8 @@ double scoreMove(std::vector<int> &board, int move, bool player1) {
     }
     else { //player2
         while (marbles != 0) {
-            if (curr != 6) { //don't put anything in opponents store
-                if (curr == 13) {
+            if (curr != Variant::MAX_KALAH) { //don't put anything in opponents store
+                if (curr == Variant::MIN_KALAH) {
                     //scoring pot
                     scores++;
 
@@ -564,32 +995,13 @@ double scoreMove(std::vector<int> &board, int move, bool player1) {
                         multiMove = true;
                     }
                 }
-                else if (curr > 6) {
+                else if (curr > Variant::MAX_KALAH) {
                     //test for capture
                     if (marbles == 1 && temp_board[curr] == 0) {
                         scores++; //store the last marble
 
                         //store the opposing opponent pot
-                        switch(curr) {
-                            case 7: scores += temp_board[5];
-                                temp_board[5] == 0;
-                                break;
-                            case 8: scores += temp_board[4];
-                                temp_board[4] == 0;
-                                break;
-                            case 9: scores += temp_board[3];
-                                temp_board[3] == 0;
-                                break;
-                            case 10: scores += temp_board[2];
-                                temp_board[2] == 0;
-                                break;
-                            case 11: scores += temp_board[1];
-                                temp_board[1] == 0;
-                                break;
-                            case 12: scores += temp_board[0];
-                                temp_board[0] == 0;
-                                break;
-                        }
+                        scores += temp_board[Variant::tables.across[curr]];
                     }
                     else {
                         //not a capture, but still our own pot
@@ -597,25 +1009,25 @@ double scoreMove(std::vector<int> &board, int move, bool player1) {
                     }
                 }
 
-                else if (curr < 6) {
+                else if (curr < Variant::PITS) {
                     //opponents pot
                     overflows++;
                 }
             }
-            curr = (curr + 1) % 14;
+            curr = (curr + 1) % Variant::JARS;
             marbles--;
         }
 
         if (multiMove) {
-            scores *= 1.5;
+            scores *= weights.multi_move;
         }
 
-        moveScore = scores - ((overflows * 0.3) * (overflows * 0.3));
+        moveScore = scores - ((overflows * weights.overflow) * (overflows * weights.overflow));
 
         double maxOpScore = 0;
-        for (int i = 0; i < 6; ++i) {
+        for (int i = 0; i < Variant::PITS; ++i) {
             //score this move
-            opScore = scoreOpMove(temp_board, i, true);
+            opScore = scoreOpMove< Variant >(temp_board, i, true, weights);
 
             if (opScore > maxOpScore) {
                 maxOpScore = opScore;
@@ -630,63 +1042,55 @@ double scoreMove(std::vector<int> &board, int move, bool player1) {
     }
 }
 
-double PlayGame::alabandi_heuristic(Node& state)
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::alabandi_heuristic(Node& state)
 {
-    int player = 2 - state.player_max;
+    // Scored for the player who just moved. When that is min (max to
+    // move) this is the same formula on the mirrored board (see
+    // Position.h), so the jars are read shifted by half the board in that case.
+    const int jars = Variant::JARS;
+    int side = (PITS + 1) * state.player_max;
     int i;
-    int score;
-
-    // Kalah counts 6 times more, but stones count too.
-    if(player == 2)
-    {
-
-        score = 6 * ( state.board[6] - state.board[13] );
-
+    int stones = 0;
 
-        for ( i = 0; i <= 5; i++ )
-            score += state.board[i];
+    // Kalah counts 6 times more (weights.kalah), but stones count too.
+    int kalahs = state.board[(Variant::MAX_KALAH + side) % jars] - state.board[(Variant::MIN_KALAH + side) % jars];
 
-        for ( i = 7; i <= 12; i++ )
-            score -= state.board[i];
-    }
-    else if (player == 1)
-    {
-        score = 6 * ( state.board[13] - state.board[6] );
-
-        for ( i = 0; i <= 5; i++ )
-            score -= state.board[i];
+    for ( i = 0; i < PITS; i++ )
+        stones += state.board[(i + side) % jars];
 
-        for ( i = 7; i <= 12; i++ )
-            score += state.board[i];
-    }
+    for ( i = PITS + 1; i < Variant::MIN_KALAH; i++ )
+        stones -= state.board[(i + side) % jars];
 
-    return score;
+    return options.weights.kalah * kalahs + stones;
 }
 
-double PlayGame::bell_heuristic(Node& state){
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::bell_heuristic(Node& state){
     //First calculate the difference in scores
-    //Then add a fifth the number of seeds that are in jars which
-    //can't play into opponent's jars.
-    double score = state.board[6] - state.board[13];
-    double coeff = .2;
-    for(int i = 0; i < 6; i++){
-        if(state.board[i] < 6 - i) score+= coeff * (state.board[i]);
+    //Then add a fifth (weights.bell) the number of seeds that are in
+    //jars which can't play into opponent's jars.
+    double score = state.board[Variant::MAX_KALAH] - state.board[Variant::MIN_KALAH];
+    double coeff = options.weights.bell;
+    for(int i = 0; i < PITS; i++){
+        if(state.board[i] < Variant::MAX_KALAH - i) score+= coeff * (state.board[i]);
     }
-    for(int i = 7; i < 13; i++){
-        if(state.board[i] < 13 - i) score-= coeff * (state.board[i]);
+    for(int i = PITS + 1; i < Variant::MIN_KALAH; i++){
+        if(state.board[i] < Variant::MIN_KALAH - i) score-= coeff * (state.board[i]);
     }
     return score;
 }
 
-double PlayGame::coplin_heuristic(Node& inNode) {
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::coplin_heuristic(Node& inNode) {
     //evaluate move
     double score = 0;
     double maxScore = 0;
 
     if (inNode.player_max) {
-        for (int i = 0; i < 6; ++i) {
+        for (int i = 0; i < PITS; ++i) {
             //score this move
-            score = scoreMove(inNode.board, i, true);
+            score = scoreMove< Variant >(inNode.board, i, true, options.weights);
 
             if (score > maxScore) {
                 maxScore = score;
@@ -694,9 +1098,9 @@ double PlayGame::coplin_heuristic(Node& inNode) {
         }
     }
     else {
-        for (int i = 7; i < 13; ++i) {
+        for (int i = PITS + 1; i < Variant::MIN_KALAH; ++i) {
             //score this move
-            score = scoreMove(inNode.board, i, false);
+            score = scoreMove< Variant >(inNode.board, i, false, options.weights);
 
             if (score > maxScore) {
                 maxScore = score;
@@ -707,15 +1111,17 @@ double PlayGame::coplin_heuristic(Node& inNode) {
     return maxScore;
 }
 
-double PlayGame::simple_heuristic(Node& state){
-    return state.board[6] - state.board[13];
+template< int PITS, int SEEDS >
+double BasicPlayGame< PITS, SEEDS >::simple_heuristic(Node& state){
+    return state.board[Variant::MAX_KALAH] - state.board[Variant::MIN_KALAH];
 }
 
 /******************************************************************************
 /  Misc. Functions
 /*****************************************************************************/
 
-void PlayGame::output_path(){
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::output_path(){
     for(int i = 0; i < path.size(); i++){
         for(int j = 0; j < path[i].size(); j++){
             std::cout << path[i][j] << " ";
@@ -724,11 +1130,28 @@ void PlayGame::output_path(){
     }
 }
 
-void PlayGame::output_path(std::ofstream& fout){
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::output_path(std::ofstream& fout){
     for(int i = 0; i < path.size(); i++){
         for(int j = 0; j < path[i].size(); j++){
             fout << path[i][j] << " ";
         }
         if(i + 1 != path.size()) fout << "--> ";
     }
-}
\ No newline at end of file
+}
+
+template< int PITS, int SEEDS >
+void BasicPlayGame< PITS, SEEDS >::check_budget(){
+    //the search unwinds as soon as this is set, see max_value, min_value
+    //and minimax_a_b for how the root move is then picked
+    if(options.node_limit > 0 && children_generated >= options.node_limit) budget_hit = true;
+    if(options.memory_limit > 0 && memory_used >= options.memory_limit) budget_hit = true;
+    if(options.yield_every > 0 && !budget_hit && children_generated % options.yield_every == 0
+       && options.yield && !options.yield()) budget_hit = true;
+}
+
+//the variants which can be played, see main's --variant
+template class BasicPlayGame< 6, 6 >;
+template class BasicPlayGame< 4, 4 >;
+template class BasicPlayGame< 5, 5 >;
+template class BasicPlayGame< 6, 4 >;
@@ -7,54 +7,116 @@
 #include <memory>
 #include <vector>
 #include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "BatchEval.h"
+#include "Weights.h"
+#include "Variant.h"
+
+class TranspositionTable;
+class EvalCache;
+struct Reductions;
+
+//Score of a won game for max (negated for min). One is taken off per ply
+//so a quicker win scores higher. It is far beyond any heuristic value.
+const double WIN_SCORE = 1000000;
+
+//Search settings which are not needed for a plain game. The defaults
+//reproduce the original behavior of the engine. Used as PlayGame::Options.
+struct SearchOptions{
+    long node_limit; //stop after this many nodes, 0 for no limit
+    std::size_t memory_limit; //stop after roughly this many bytes of tree, 0 for no limit
+    long quiescence_node_limit; //nodes allowed past max_depth per search, 0 turns quiescence off
+    TranspositionTable* table; //may be shared with other searches and threads, nullptr for none
+    bool batch_leaves; //score the leaves below a node together, see BatchEval.h
+    Weights weights; //constants used by the heuristics
+    long yield_every; //nodes made between calls to yield, 0 for never
+    //lets the search be paused (see Scheduler.h), returning false
+    //stops it as if a budget was reached
+    std::function< bool() > yield;
+    //late move reductions and extensions for Norvig and Luger's search,
+    //see Reductions.h, nullptr for none. Turns batch_leaves off.
+    const Reductions* reductions;
+    EvalCache* eval_cache; //heuristic values of leaf boards, may be shared like table, nullptr for none
+
+    SearchOptions() : node_limit(0), memory_limit(0), quiescence_node_limit(0), table(nullptr), batch_leaves(false),
+                      yield_every(0), reductions(nullptr), eval_cache(nullptr){}
+};
+
+//A position in the search tree, the same for every variant. Used as PlayGame::Node.
+struct SearchNode{
+    /* Connectors */
+    std::vector< std::unique_ptr< SearchNode >> children;
+    std::vector< double > children_value;
+    SearchNode* parent;
+
+    /* Data */
+    std::vector< int > board; //board for the current node
+    int depth; //depth of the current node
+    int horizon; //depth at which this node's line is cut off, max_depth unless reduced or extended
+    bool player_max; //max is player 1, false => player 2 (min)
+    std::vector< int > result_of_play; //this will save the actions by the parent to get to here
+    int captured; //seeds captured by result_of_play
+    std::vector< std::vector< int > > action; //all possible actions that can be made from this board
+    int selected; //index to the selected action from above
+    double heuristic_value; //used in Rich&Knight for keeping value on node
+
+    //Node constructor
+    SearchNode() : children(0), children_value(0), board(0), result_of_play(0), action(0){
+        parent == nullptr;
+        depth = 0;
+        horizon = 0;
+        captured = 0;
+        player_max = 0;
+        selected = 0;
+        heuristic_value = 0;
+    }
+};
 
-class PlayGame{
+//The engine for Kalah with PITS pits a side and SEEDS seeds a pit, see
+//Variant.h for the board layout. PlayGame, below, is Kalah(6,6). The
+//members are defined in PlayGame.cpp, which instantiates the variants
+//that can be played.
+template< int PITS, int SEEDS >
+class BasicPlayGame{
 public:
+    typedef KalahVariant< PITS, SEEDS > Variant;
+    typedef SearchOptions Options;
+    typedef SearchNode Node;
+
     //Constructor, call this to make a move.
     //To retrieve the move's new board, examine PlayGame.next_moves_board
     //To retrieve the move's value, examine PlayGame.heuristic_score
     //To retrieve the move's path, examine PlayGame.path
-    //    Board: vector of size 14 representing the current board state
+    //Only the root and its children are kept once the search is done.
+    //    Board: vector of size Variant::JARS (14) representing the current board state
     //algorithm: 0 for Rich + Knight, 1 for Norvig and Russell
     //   player: 0 for min's turn, 1 for max's turn
     //heuristic: -1 for current score, 0 for alabandi, 1 for bell, 2 for coplin
-    PlayGame(std::vector<int>& board, bool algorithm, bool player, int heuristic, int max_depth);
-
-    struct Node{
-        /* Connectors */
-        std::vector< std::unique_ptr< Node >> children;
-        std::vector< double > children_value;
-        Node* parent;
-
-        /* Data */
-        std::vector< int > board; //board for the current node
-        int depth; //depth of the current node
-        bool player_max; //max is player 1, false => player 2 (min)
-        std::vector< int > result_of_play; //this will save the actions by the parent to get to here
-        std::vector< std::vector< int > > action; //all possible actions that can be made from this board
-        int selected; //index to the selected action from above
-        double heuristic_value; //used in Rich&Knight for keeping value on node
-
-        //Node constructor
-        Node() : children(0), children_value(0), board(0), result_of_play(0), action(0){
-            parent == nullptr;
-            depth = 0;
-            player_max = 0;
-            selected = 0;
-            heuristic_value = 0;
-        }
-    };
+    BasicPlayGame(std::vector<int>& board, bool algorithm, bool player, int heuristic, int max_depth);
+    BasicPlayGame(std::vector<int>& board, bool algorithm, bool player, int heuristic, int max_depth, const Options& options);
 
     /* Tree Data */
 
     std::unique_ptr< Node > root; //starting node
     int max_depth; //maximum depth of the tree
     std::vector< int > move; //integers corresponding to the next move
-    std::vector< std::vector< int >> path; //the path of predicted moves
+    std::vector< std::vector< int >> path; //the path of predicted moves, row 0 of pv
     int children_generated; //Number of nodes made overall (root inclusive)
     int function_used; //0 for Ghadeer's, 1 for Chris's, 2 for Jared's, other for simple dif of score
     double heuristic_score; //score of the move based upon the heuristic used
     std::vector< int > next_moves_board; //board after playing the found move
+    Options options; //search settings given to the constructor
+    std::size_t memory_used; //approximate bytes held by the tree, searched subtrees are freed
+    bool budget_hit; //true if a limit or yield stopped the search early
+    long quiescence_nodes; //nodes looked at past max_depth, not part of children_generated
+    long table_probes; //transposition table lookups
+    long table_hits; //lookups which found the position
+    long reduced_searches; //late moves searched at a reduced depth
+    long re_searches; //reduced moves which beat the bound and were searched again in full
+    long eval_probes; //evaluation cache lookups
+    long eval_hits; //lookups which found the board
 
     /* Functions */
     /*
@@ -64,6 +126,44 @@ public:
     double max_value(Node& state, double alpha, double beta);
     double min_value(Node& state, double alpha, double beta);
     bool cutoff_test(Node& state);
+    //makes child i of state and searches it, reduced or extended as options.reductions says
+    double search_child(Node& state, int i, double alpha, double beta);
+    int extension(Node& state, Node& child); //plies added to child's horizon
+
+    /*
+     * Leaf evaluation, shared by both algorithms
+     */
+    //Both return values as seen by max, like calculate_heuristic
+    double leaf_value(Node& state, double alpha, double beta);
+    double quiescence(Node& state, double alpha, double beta); //plays out captures and chains
+    double static_value(Node& state); //exact score if the game is decided, else the heuristic
+    double bounded_value(Node& state, double value); //heuristic value held to what state can still reach
+    //makes and scores every child of state if they are all leaves, false if not
+    bool batch_leaves(Node& state, std::vector< double >& values);
+    LeafBatch leaf_batch; //reused by batch_leaves
+    void outcome_bounds(Node& state, double& low, double& high); //range of values reachable below state
+
+    /*
+     * Transposition table, used by Norvig and Luger's algorithm
+     */
+    uint64_t table_key(Node& state, bool& mirrored);
+    //true if the stored value settles state, best is set to the stored action either way
+    bool probe_table(Node& state, double alpha, double beta, double& value, int& best);
+    void store_table(Node& state, double alpha, double beta, double value, int best);
+    void order_actions(Node& state, int& best); //moves action best to the front
+
+    /*
+     * Principal variation, collected as the search goes
+     */
+    //A triangle of lines, one row per depth. Row d starts at pv_row(d)
+    //and holds the best line found so far from the node being searched
+    //at depth d, pv_length[d] moves long. Sized once by the constructor.
+    std::vector< std::vector< int > > pv;
+    std::vector< int > pv_length;
+    int pv_plies; //deepest a node can be, max_depth plus any extensions
+    std::size_t pv_row(int depth);
+    void update_pv(Node& state, int i); //action i of state starts its line, followed by the line below child i
+    std::size_t release_children(Node& state); //frees the searched tree below state, returns the bytes freed
 
 
     /*
@@ -79,14 +179,17 @@ public:
     void generate_children(Node&);
     void generate_child(Node &state, int i);
     void actions(Node&);
+    static void legal_actions(Node&); //same as actions, without counting the search's memory
     Node* result(Node&, std::vector< int >);
-    void actions_move_again(Node& state, std::vector<int> half_board, std::vector<int> currentAction);
+    static void actions_move_again(Node& state, std::vector<int> half_board, std::vector<int> currentAction);
 
 
     /*
      *  Heuristic and helpers
      */
     double calculate_heuristic(Node&, int); //heuristic handler, calls the correct heuristic
+    double cached_heuristic(Node&); //calculate_heuristic with function_used, through options.eval_cache
+    uint64_t eval_salt; //sets cache keys of this search's heuristic, weights and variant apart
     double alabandi_heuristic(Node&);
     double bell_heuristic(Node&);
     double coplin_heuristic(Node&);
@@ -97,9 +200,31 @@ public:
      */
     void output_path(); //used to output move's path to console
     void output_path(std::ofstream&); //used to output move's path to file
+    void check_budget(); //sets budget_hit once a limit in options is reached, calls yield
+
+    /*
+     * Board functions
+     */
+    //helper function for end with rich & knight minimax
+    //also true once a kalah holds more than half of the seeds
+    static bool terminal_board(const std::vector< int >& board);
+    //exact score of a decided board for max, see WIN_SCORE
+    static double exact_score(const std::vector< int >& board, int depth);
+    //plays a whole turn on board, returns the seeds captured doing so
+    static int sow(std::vector< int >& board, bool player_max, const std::vector< int >& action);
+    static std::vector< int > starting_board(); //every pit holding SEEDS
 };
 
-//helper function for end with rich & knight minimax
-bool terminal_board(std::vector< int >);
+typedef BasicPlayGame< 6, 6 > PlayGame;
+
+//The board functions of Kalah(6,6), for code which only plays that
+inline bool terminal_board(const std::vector< int >& board){ return PlayGame::terminal_board(board); }
+inline double exact_score(const std::vector< int >& board, int depth){ return PlayGame::exact_score(board, depth); }
+inline int sow(std::vector< int >& board, bool player_max, const std::vector< int >& action){
+    return PlayGame::sow(board, player_max, action);
+}
+
+//index an action had before PlayGame::order_actions moved best to the front
+int unordered_index(int i, int best);
 
 #endif //TERMINALAPP_PLAYGAME_H
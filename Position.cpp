@@ -0,0 +1,105 @@
+//
+// Side-swap symmetry and hashing of Kalah positions.
+//
+
+#include "Position.h"
+
+//a jar never holds more than every seed on the board, and no variant
+//is bigger than Kalah(6,6)
+static const int MAX_SEEDS = 72;
+static const int MAX_JARS = 14;
+
+struct ZobristKeys{
+    uint64_t jar[MAX_JARS][MAX_SEEDS + 1];
+    uint64_t max_to_move;
+
+    ZobristKeys(){
+        //splitmix64, fixed seed so keys are the same from run to run
+        uint64_t state = 0x4b616c6168ULL;
+        for(int i = 0; i < MAX_JARS; i++){
+            for(int j = 0; j <= MAX_SEEDS; j++){
+                jar[i][j] = next(state);
+            }
+        }
+        max_to_move = next(state);
+    }
+
+    static uint64_t next(uint64_t& state){
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+static const ZobristKeys& keys(){
+    static const ZobristKeys zobrist;
+    return zobrist;
+}
+
+void mirror_board(const std::vector< int >& board, std::vector< int >& mirrored){
+    int jars = board.size();
+    mirrored.resize(jars);
+    for(int i = 0; i < jars; i++){
+        mirrored[mirrored_jar(i, jars)] = board[i];
+    }
+}
+
+uint64_t position_hash(const std::vector< int >& board, bool player_max){
+    const ZobristKeys& zobrist = keys();
+    uint64_t hash = player_max ? zobrist.max_to_move : 0;
+    for(int i = 0; i < board.size(); i++){
+        hash ^= zobrist.jar[i][board[i]];
+    }
+    return hash;
+}
+
+uint64_t canonical_hash(const std::vector< int >& board, bool player_max, bool& mirrored){
+    //hashes the mirrored jars in place rather than building the mirror
+    const ZobristKeys& zobrist = keys();
+    int jars = board.size();
+    mirrored = !player_max;
+    uint64_t hash = zobrist.max_to_move;
+    if(mirrored){
+        for(int i = 0; i < jars; i++){
+            hash ^= zobrist.jar[mirrored_jar(i, jars)][board[i]];
+        }
+    } else{
+        for(int i = 0; i < jars; i++){
+            hash ^= zobrist.jar[i][board[i]];
+        }
+    }
+    return hash;
+}
+
+int heuristic_symmetry(int heuristic){
+    //see PlayGame::calculate_heuristic for the numbering
+    if(heuristic == 0) return 1; //alabandi scores for the player who just moved
+    if(heuristic == 1) return 0; //bell sums in a different order once mirrored
+    if(heuristic == 2) return 1; //coplin scores the best move of the side to move
+    return -1; //the simple kalah difference
+}
+
+int search_symmetry(int heuristic){
+    //Max and min trade places in a mirrored search, which only maps
+    //values onto each other when the leaves are negated as well, so only
+    //the simple heuristic shares table entries with mirrored positions.
+    //Alabandi's and Coplin's score for a player rather than for max, so
+    //their searched values have no relation to the mirror's. Bell's is
+    //negated by mirroring in exact arithmetic, but it sums its jars in
+    //another order, so the two values can differ in the last bits and
+    //sharing them would let the move depend on which side was searched
+    //first.
+    return heuristic_symmetry(heuristic) < 0 ? -1 : 0;
+}
+
+PositionKey position_key(const std::vector< int >& board, bool player_max, int symmetry){
+    PositionKey key;
+    if(symmetry != 0){
+        key.hash = canonical_hash(board, player_max, key.mirrored);
+    } else{
+        key.hash = position_hash(board, player_max);
+        key.mirrored = false;
+    }
+    return key;
+}
@@ -0,0 +1,56 @@
+//
+// Side-swap symmetry and hashing of Kalah positions.
+//
+
+#ifndef TERMINALAPP_POSITION_H
+#define TERMINALAPP_POSITION_H
+#include <vector>
+#include <cstdint>
+
+//Swapping the two halves of the board (jars 0-6 with 7-13 in Kalah(6,6),
+//see Variant.h for the others) and handing
+//the move to the other player gives the same game with the players'
+//roles swapped. The canonical form of a position is the one with the
+//side to move sitting on jars 0-6, so a position and its mirror share
+//one key.
+
+//mirror of jar i on a board of the given size, the jar it lands on when
+//the halves are swapped
+inline int mirrored_jar(int i, int jars){ return (i + jars / 2) % jars; }
+
+//fills mirrored with board's halves swapped
+void mirror_board(const std::vector< int >& board, std::vector< int >& mirrored);
+
+//Zobrist hash of the board exactly as given, with the side to move
+uint64_t position_hash(const std::vector< int >& board, bool player_max);
+
+//Zobrist hash of the canonical form. mirrored is set if the canonical
+//form is board mirrored, which is when min is to move.
+uint64_t canonical_hash(const std::vector< int >& board, bool player_max, bool& mirrored);
+
+//How a value changes when the position is mirrored:
+//  -1 it is negated, 1 it is unchanged, 0 there is no exact relation
+//heuristic_symmetry is for a single evaluation of the given heuristic,
+//search_symmetry is for a searched value (exact scores included) using it.
+//Only the simple heuristic has a search symmetry (see Position.cpp).
+int heuristic_symmetry(int heuristic);
+int search_symmetry(int heuristic);
+
+//Key for tables shared between a position and its mirror. Positions are
+//only folded together when symmetry isn't 0. Values are stored as seen
+//in the canonical form, to_canonical and from_canonical do the sign
+//adjustment. They negate as 0 - value, so a score of 0 never comes back
+//as -0.
+struct PositionKey{
+    uint64_t hash;
+    bool mirrored;
+};
+PositionKey position_key(const std::vector< int >& board, bool player_max, int symmetry);
+inline double to_canonical(double value, const PositionKey& key, int symmetry){
+    return (key.mirrored && symmetry < 0) ? 0 - value : value;
+}
+inline double from_canonical(double value, const PositionKey& key, int symmetry){
+    return (key.mirrored && symmetry < 0) ? 0 - value : value;
+}
+
+#endif //TERMINALAPP_POSITION_H
@@ -0,0 +1,68 @@
+//
+// How much shallower late quiet moves are searched, and how much deeper
+// forcing ones are, in Norvig and Luger's search (see PlayGame::max_value).
+//
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "Reductions.h"
+
+Reductions::Reductions(){
+    for(int left = 0; left < MAX_PLIES; left++){
+        for(int move = 0; move < MAX_MOVES; move++){
+            int taken = 0;
+            if(move >= 2 && left >= 3) taken = 1;
+            if(move >= 4 && left >= 5) taken = 2;
+            if(move >= 5 && left >= 7) taken = 3;
+            plies[left][move] = taken;
+        }
+    }
+    single_reply = 1;
+    capture_chain = 1;
+    chain_length = 5;
+    max_extension = 2;
+}
+
+int Reductions::reduction(int plies_left, int move_index) const{
+    if(plies_left < 0) return 0;
+    if(plies_left >= MAX_PLIES) plies_left = MAX_PLIES - 1;
+    if(move_index >= MAX_MOVES) move_index = MAX_MOVES - 1;
+    return plies[plies_left][move_index];
+}
+
+bool load_reductions(const std::string& file_name, Reductions& reductions){
+    std::ifstream file(file_name.c_str());
+    if(!file.is_open()) return false;
+    //read into a copy so a bad file leaves reductions alone
+    Reductions loaded = reductions;
+    std::string line;
+    while(std::getline(file, line)){
+        std::size_t comment = line.find('#');
+        if(comment != std::string::npos) line.erase(comment);
+        std::istringstream fields(line);
+        std::string name;
+        if(!(fields >> name)) continue; //blank line
+        if(name == "plies"){
+            int left;
+            std::vector< int > row;
+            int value;
+            if(!(fields >> left) || left < 0 || left >= Reductions::MAX_PLIES) return false;
+            while(fields >> value) row.push_back(value);
+            if(row.empty() || row.size() > Reductions::MAX_MOVES) return false;
+            for(int move = 0; move < Reductions::MAX_MOVES; move++){
+                loaded.plies[left][move] = row[move < row.size() ? move : row.size() - 1];
+            }
+            continue;
+        }
+        int value;
+        if(!(fields >> value)) return false;
+        if(name == "single_reply") loaded.single_reply = value;
+        else if(name == "capture_chain") loaded.capture_chain = value;
+        else if(name == "chain_length") loaded.chain_length = value;
+        else if(name == "max_extension") loaded.max_extension = value;
+        else return false;
+    }
+    reductions = loaded;
+    return true;
+}
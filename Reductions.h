@@ -0,0 +1,41 @@
+//
+// How much shallower late quiet moves are searched, and how much deeper
+// forcing ones are, in Norvig and Luger's search (see PlayGame::max_value).
+//
+
+#ifndef TERMINALAPP_REDUCTIONS_H
+#define TERMINALAPP_REDUCTIONS_H
+#include <string>
+
+struct Reductions{
+    static const int MAX_PLIES = 16; //rows, plies left below the node
+    static const int MAX_MOVES = 32; //columns, index of the move in the node's order
+
+    //[plies left][move index] plies taken off a quiet move, one that is a
+    //single jar and captures nothing. The last row and column stand for
+    //anything past them. A move found above alpha is searched again in full.
+    int plies[MAX_PLIES][MAX_MOVES];
+    int single_reply; //plies added below a node with only one move
+    int capture_chain; //plies added for a chain of chain_length or more jars ending in a capture
+    int chain_length;
+    int max_extension; //most plies a line may be extended past max_depth
+
+    //The default leaves the first two moves alone and takes a ply off
+    //the rest when three or more plies are left, two from the fifth move
+    //when five are left and three from the sixth when seven are. Without
+    //a transposition table to put the best move first the order is
+    //only actions()'s, so this is about as far as reducing goes before
+    //play suffers. Extensions are one ply each, for chains of five or
+    //more jars, up to two in a line.
+    Reductions();
+
+    int reduction(int plies_left, int move_index) const;
+};
+
+//Files hold lines of "name value" for the extensions and lines of
+//"plies P r0 r1 r2 ..." setting row P from column 0, a row's last value
+//repeating to the end. # starts a comment. false if the file can't be
+//read or has a line which doesn't fit.
+bool load_reductions(const std::string& file_name, Reductions& reductions);
+
+#endif //TERMINALAPP_REDUCTIONS_H
@@ -0,0 +1,312 @@
+//
+// A fixed corpus of positions searched with every algorithm, heuristic
+// and a few depths, checked against a baseline of the moves, scores,
+// node counts and times found before.
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "Regression.h"
+#include "PlayGame.h"
+#include "Tools.h"
+
+//every corpus position is searched with each algorithm, heuristic and depth
+static const int REGRESSION_DEPTHS[2] = {3, 6};
+static const char* PHASE_NAME[3] = {"opening", "middlegame", "endgame"};
+
+struct Position{
+    std::vector< int > board;
+    bool player_max;
+};
+
+//what a search found, a line of the baseline file
+struct SearchRecord{
+    std::vector< int > move;
+    double score;
+    long nodes;
+    long microseconds;
+};
+
+typedef std::tuple< int, int, int, int > SearchId; //position, algorithm, heuristic, depth
+
+static int phase_of(const std::vector< int >& board){
+    //by the seeds still in the pits
+    int seeds = 0;
+    for(int i = 0; i < 14; i++){
+        if(i != 6 && i != 13) seeds += board[i];
+    }
+    if(seeds >= 60) return 0;
+    if(seeds >= 30) return 1;
+    return 2;
+}
+
+int make_corpus(const std::string& corpus_file, int per_phase){
+    //Random games, taking at most one position of each phase from a game
+    //at a random ply, until every phase has per_phase. Decided positions
+    //are left out, as there is nothing to search.
+    std::ofstream out(corpus_file.c_str());
+    if(!out.is_open()){
+        std::cout << "Can't write " << corpus_file << std::endl;
+        return 1;
+    }
+    out << "# jars 0-13, 1 if max is to move, phase. Made by ./kalah --regress-corpus" << std::endl;
+    std::mt19937 random(2017);
+    int found[3] = {0, 0, 0};
+    while(found[0] < per_phase || found[1] < per_phase || found[2] < per_phase){
+        std::vector< std::pair< std::vector< int >, bool > > game;
+        std::vector< int > board = PlayGame::starting_board();
+        bool player_max = true;
+        while(!terminal_board(board)){
+            PlayGame::Node state;
+            state.board = board;
+            state.player_max = player_max;
+            PlayGame::legal_actions(state);
+            if(state.action.empty()) break;
+            game.push_back(std::make_pair(board, player_max));
+            sow(board, player_max, state.action[random() % state.action.size()]);
+            player_max = !player_max;
+        }
+        std::vector< int > plies[3];
+        for(int ply = 0; ply < game.size(); ply++) plies[phase_of(game[ply].first)].push_back(ply);
+        for(int phase = 0; phase < 3; phase++){
+            if(found[phase] >= per_phase || plies[phase].empty()) continue;
+            const std::pair< std::vector< int >, bool >& picked = game[plies[phase][random() % plies[phase].size()]];
+            for(int i = 0; i < 14; i++) out << picked.first[i] << " ";
+            out << picked.second << " " << PHASE_NAME[phase] << std::endl;
+            found[phase]++;
+        }
+    }
+    std::cout << "Wrote " << 3 * per_phase << " positions to " << corpus_file << std::endl;
+    return 0;
+}
+
+static bool read_corpus(const std::string& corpus_file, std::vector< Position >& corpus){
+    std::ifstream in(corpus_file.c_str());
+    if(!in.is_open()){
+        std::cout << "Can't read " << corpus_file << std::endl;
+        return false;
+    }
+    std::string line;
+    while(std::getline(in, line)){
+        if(line.empty() || line[0] == '#') continue;
+        Position position;
+        if(!parse_position(line, position.board, position.player_max)){
+            std::cout << "Bad position in " << corpus_file << ": " << line << std::endl;
+            return false;
+        }
+        corpus.push_back(position);
+    }
+    return true;
+}
+
+static SearchRecord search(const Position& position, int algorithm, int heuristic, int depth){
+    std::vector< int > board = position.board;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    PlayGame searched(board, algorithm, position.player_max, heuristic, depth);
+    SearchRecord record;
+    record.microseconds = std::chrono::duration_cast< std::chrono::microseconds >(
+        std::chrono::steady_clock::now() - start).count();
+    record.move = searched.move;
+    record.score = searched.heuristic_score;
+    record.nodes = searched.children_generated;
+    return record;
+}
+
+//A search timed when the baseline is recorded and again before and after
+//the corpus is searched, so baseline times can be scaled to the machine
+//and its load at hand. The fastest of a few runs is taken, as load only
+//ever adds time.
+static const int CALIBRATION_DEPTH = 8;
+static const int CALIBRATION_RUNS = 5;
+
+static long calibrate(){
+    Position start;
+    start.board = PlayGame::starting_board();
+    start.player_max = true;
+    long fastest = 0;
+    for(int run = 0; run < CALIBRATION_RUNS; run++){
+        long microseconds = search(start, 1, 3, CALIBRATION_DEPTH).microseconds;
+        if(run == 0 || microseconds < fastest) fastest = microseconds;
+    }
+    return std::max(fastest, 1L);
+}
+
+//calls found for every search of the corpus, in the baseline's order
+template< class Found >
+static void search_corpus(const std::vector< Position >& corpus, Found found){
+    for(int index = 0; index < corpus.size(); index++){
+        for(int algorithm = 0; algorithm < 2; algorithm++){
+            for(int heuristic = 0; heuristic < 4; heuristic++){
+                for(int d = 0; d < 2; d++){
+                    int depth = REGRESSION_DEPTHS[d];
+                    found(SearchId(index, algorithm, heuristic, depth), search(corpus[index], algorithm, heuristic, depth));
+                }
+            }
+        }
+    }
+}
+
+static std::string move_text(const std::vector< int >& move){
+    std::ostringstream text;
+    for(int i = 0; i < move.size(); i++) text << (i ? "," : "") << move[i];
+    return text.str();
+}
+
+int record_baseline(const std::string& corpus_file, const std::string& baseline_file){
+    std::vector< Position > corpus;
+    if(!read_corpus(corpus_file, corpus)) return 1;
+    std::ofstream out(baseline_file.c_str());
+    if(!out.is_open()){
+        std::cout << "Can't write " << baseline_file << std::endl;
+        return 1;
+    }
+    //calibrated before and after the corpus, as a run is, so the
+    //searches are kept until the calibration line can be written
+    long calibration = calibrate();
+    std::ostringstream searches;
+    searches << std::setprecision(17);
+    search_corpus(corpus, [&](const SearchId& id, const SearchRecord& record){
+        searches << std::get<0>(id) << " " << std::get<1>(id) << " " << std::get<2>(id) << " " << std::get<3>(id)
+                 << " " << move_text(record.move) << " " << record.score << " " << record.nodes << " "
+                 << record.microseconds << std::endl;
+    });
+    calibration = std::min(calibration, calibrate());
+    out << "# position algorithm heuristic depth move score nodes microseconds. Made by ./kalah --regress-record"
+        << std::endl;
+    out << "# calibration " << calibration << std::endl;
+    out << searches.str();
+    std::cout << "Wrote " << corpus.size() * 16 << " searches to " << baseline_file << std::endl;
+    return 0;
+}
+
+//calibration is set to 0 for a baseline from before there was one
+static bool read_baseline(const std::string& baseline_file, std::map< SearchId, SearchRecord >& baseline,
+                          long& calibration){
+    std::ifstream in(baseline_file.c_str());
+    if(!in.is_open()){
+        std::cout << "Can't read " << baseline_file << std::endl;
+        return false;
+    }
+    calibration = 0;
+    std::string line;
+    while(std::getline(in, line)){
+        if(line.compare(0, 14, "# calibration ") == 0) calibration = atol(line.c_str() + 14);
+        if(line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        int index, algorithm, heuristic, depth;
+        std::string move;
+        SearchRecord record;
+        if(!(fields >> index >> algorithm >> heuristic >> depth >> move >> record.score >> record.nodes
+                    >> record.microseconds)){
+            std::cout << "Bad line in " << baseline_file << ": " << line << std::endl;
+            return false;
+        }
+        std::istringstream jars(move);
+        std::string jar;
+        while(std::getline(jars, jar, ',')) record.move.push_back(atoi(jar.c_str()));
+        baseline[SearchId(index, algorithm, heuristic, depth)] = record;
+    }
+    return true;
+}
+
+int run_regression(const std::string& corpus_file, const std::string& baseline_file, double node_threshold,
+                   double time_threshold){
+    std::vector< Position > corpus;
+    std::map< SearchId, SearchRecord > baseline;
+    long baseline_calibration;
+    if(!read_corpus(corpus_file, corpus) || !read_baseline(baseline_file, baseline, baseline_calibration)) return 1;
+    long calibration = calibrate();
+
+    //totals for each algorithm, heuristic and depth
+    struct Group{
+        int positions = 0;
+        int moves_changed = 0;
+        int scores_changed = 0;
+        int nodes_regressed = 0;
+        double nodes = 0, baseline_nodes = 0;
+        double microseconds = 0, baseline_microseconds = 0;
+    };
+    std::map< std::tuple< int, int, int >, Group > groups;
+    std::vector< std::string > failures;
+    int missing = 0;
+    search_corpus(corpus, [&](const SearchId& id, const SearchRecord& record){
+        std::map< SearchId, SearchRecord >::const_iterator found = baseline.find(id);
+        if(found == baseline.end()){
+            missing++;
+            return;
+        }
+        const SearchRecord& before = found->second;
+        Group& group = groups[std::make_tuple(std::get<1>(id), std::get<2>(id), std::get<3>(id))];
+        group.positions++;
+        group.nodes += record.nodes;
+        group.baseline_nodes += before.nodes;
+        group.microseconds += record.microseconds;
+        group.baseline_microseconds += before.microseconds;
+        std::ostringstream where;
+        where << "position " << std::get<0>(id) << " (" << PHASE_NAME[phase_of(corpus[std::get<0>(id)].board)]
+              << "), algorithm " << std::get<1>(id) << ", heuristic " << std::get<2>(id) << ", depth "
+              << std::get<3>(id) << ": ";
+        if(record.move != before.move){
+            group.moves_changed++;
+            failures.push_back(where.str() + "move " + move_text(record.move) + ", was " + move_text(before.move));
+        } else if(record.score != before.score){
+            group.scores_changed++;
+            std::ostringstream scores;
+            scores << std::setprecision(17) << "score " << record.score << ", was " << before.score;
+            failures.push_back(where.str() + scores.str());
+        }
+        if(record.nodes > node_threshold * before.nodes){
+            group.nodes_regressed++;
+            std::ostringstream nodes;
+            nodes << "nodes " << record.nodes << ", was " << before.nodes;
+            failures.push_back(where.str() + nodes.str());
+        }
+    });
+    calibration = std::min(calibration, calibrate());
+    //how much slower this machine, as loaded now, is than the baseline's
+    double scale = 1;
+    if(baseline_calibration > 0){
+        scale = (double)calibration / baseline_calibration;
+        std::cout << "Calibration search " << calibration / 1000.0 << " ms, was " << baseline_calibration / 1000.0
+                  << " ms; baseline times are scaled by " << scale << std::endl;
+    } else{
+        std::cout << baseline_file << " has no calibration, its times are compared as they are" << std::endl;
+    }
+
+    std::cout << "algorithm,heuristic,depth,positions,moves changed,scores changed,nodes regressed,"
+              << "nodes ratio,mean ms,baseline mean ms,time ratio" << std::endl;
+    for(std::map< std::tuple< int, int, int >, Group >::const_iterator i = groups.begin(); i != groups.end(); i++){
+        const Group& group = i->second;
+        double mean = group.microseconds / group.positions / 1000;
+        double baseline_mean = group.baseline_microseconds * scale / group.positions / 1000;
+        double time_ratio = group.microseconds / std::max(group.baseline_microseconds * scale, 1.0);
+        std::cout << std::get<0>(i->first) << "," << std::get<1>(i->first) << "," << std::get<2>(i->first) << ","
+                  << group.positions << "," << group.moves_changed << "," << group.scores_changed << ","
+                  << group.nodes_regressed << "," << group.nodes / std::max(group.baseline_nodes, 1.0) << ","
+                  << mean << "," << baseline_mean << "," << time_ratio << std::endl;
+        if(time_threshold > 0 && baseline_mean >= 1 && time_ratio > time_threshold){
+            std::ostringstream slower;
+            slower << "algorithm " << std::get<0>(i->first) << ", heuristic " << std::get<1>(i->first) << ", depth "
+                   << std::get<2>(i->first) << ": mean time " << mean << " ms, was " << baseline_mean << " ms";
+            failures.push_back(slower.str());
+        }
+    }
+    if(missing > 0) std::cout << missing << " searches have no baseline, record it again" << std::endl;
+    for(int i = 0; i < failures.size() && i < 40; i++) std::cout << failures[i] << std::endl;
+    if(failures.size() > 40) std::cout << failures.size() - 40 << " more" << std::endl;
+    if(!failures.empty()){
+        std::cout << "FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
@@ -0,0 +1,40 @@
+//
+// A fixed corpus of positions searched with every algorithm, heuristic
+// and a few depths, checked against a baseline of the moves, scores,
+// node counts and times found before.
+//
+
+#ifndef TERMINALAPP_REGRESSION_H
+#define TERMINALAPP_REGRESSION_H
+#include <string>
+
+//Corpus files hold a position a line: the 14 jars, 1 if max is to move
+//or 0 if min is, and its phase (opening, middlegame or endgame). Lines
+//starting with # are comments. Baseline files hold a line per search:
+//the position's line number in the corpus counting from 0, algorithm,
+//heuristic, depth, move (jars joined by commas), score, nodes and
+//microseconds, after a "# calibration microseconds" line timing a fixed
+//search on the machine that recorded them.
+
+//writes per_phase positions of each phase, picked from random games
+//the same way every time
+int make_corpus(const std::string& corpus_file, int per_phase);
+
+//searches the corpus and writes what was found as the baseline
+int record_baseline(const std::string& corpus_file, const std::string& baseline_file);
+
+//Searches the corpus again and compares with the baseline. Fails, with
+//1, if a move or score differs or if a position needs more than
+//node_threshold times its baseline nodes. Baseline times are scaled by
+//how much slower the calibration search runs now than when recorded,
+//and the mean time a position of an algorithm, heuristic and depth is
+//compared with them. Past time_threshold times the baseline's it fails
+//too, unless time_threshold is 0 (times below a millisecond are too
+//noisy to compare). Scaling takes out most of the difference between
+//machines and their load, not all of it, so times are only reported
+//unless a threshold is given. Node counts and times that went down are
+//reported as well.
+int run_regression(const std::string& corpus_file, const std::string& baseline_file, double node_threshold,
+                   double time_threshold);
+
+#endif //TERMINALAPP_REGRESSION_H
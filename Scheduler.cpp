@@ -0,0 +1,271 @@
+//
+// Runs many PlayGame searches on a few threads. Each search gets a stack
+// of its own and gives its thread up every few nodes (see
+// PlayGame::Options::yield), so thousands of games can be in flight and
+// share the threads in turn.
+//
+
+#include <ucontext.h>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include "Scheduler.h"
+#include "Affinity.h"
+
+//Room for the search's recursion. Pages are only touched as the stack
+//grows, so most of this is never backed by memory. Stacks are reused,
+//as mapping a new one for every search costs more than a shallow search.
+const std::size_t TASK_STACK_SIZE = 256 * 1024;
+
+//A search between submit and its end. The search runs on stack through
+//context and switches back to the worker that resumed it, which is
+//whichever thread took the task off the queue last.
+struct Scheduler::Task{
+    Request request;
+    Result result;
+    std::chrono::steady_clock::time_point submitted;
+    std::chrono::steady_clock::time_point deadline;
+    bool has_deadline;
+    bool started;
+    bool finished;
+    long sequence; //when it was queued, see Scheduler::queue
+    ucontext_t context;
+    ucontext_t* worker; //context of the worker running the task
+    char* stack;
+
+    Task() : has_deadline(false), started(false), finished(false), sequence(0), worker(nullptr), stack(nullptr){}
+
+    //true once the deadline has passed, which the result then records
+    bool expired(){
+        if(has_deadline && std::chrono::steady_clock::now() >= deadline) result.deadline_hit = true;
+        return result.deadline_hit;
+    }
+
+    //called by the search every slice_nodes nodes; false ends the search
+    //with the best move found so far
+    bool yield(){
+        if(expired()) return false;
+        swapcontext(&context, worker);
+        //the worker that took it off the queue may have found it expired
+        return !result.deadline_hit;
+    }
+};
+
+//the order of Scheduler::queue, true if a runs after b
+static bool runs_later(const Scheduler::Task* a, const Scheduler::Task* b){
+    if(a->has_deadline != b->has_deadline) return !a->has_deadline;
+    if(a->has_deadline && a->deadline != b->deadline) return a->deadline > b->deadline;
+    return a->sequence > b->sequence;
+}
+
+//makecontext only passes ints, so the task's address comes in two halves
+static void run_task(int high, int low){
+    Scheduler::Task* task = (Scheduler::Task*)(((uintptr_t)(unsigned)high << 32) | (unsigned)low);
+    Scheduler::Request& request = task->request;
+    {
+        //scoped, as this function never returns to free the tree
+        PlayGame search(request.board, request.algorithm, request.player_max, request.heuristic, request.depth,
+                        request.options);
+        task->result.move = search.move;
+        task->result.next_moves_board = search.next_moves_board;
+        task->result.heuristic_score = search.heuristic_score;
+        task->result.nodes = search.children_generated;
+    }
+    task->finished = true;
+    swapcontext(&task->context, task->worker);
+}
+
+Scheduler::Scheduler(int threads, long slice_nodes_parameter, const std::vector< int >& cpus_parameter){
+    stopping = false;
+    running = 0;
+    done_count = 0;
+    slice_count = 0;
+    queued_count = 0;
+    pin_failure_count = 0;
+    slice_nodes = slice_nodes_parameter;
+    cpus = cpus_parameter;
+    for(int t = 0; t < threads; t++) workers.push_back(std::thread(&Scheduler::work, this, t));
+}
+
+Scheduler::~Scheduler(){
+    wait_idle();
+    {
+        std::lock_guard< std::mutex > guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(int t = 0; t < workers.size(); t++) workers[t].join();
+    for(int i = 0; i < free_stacks.size(); i++) delete[] free_stacks[i];
+}
+
+void Scheduler::submit(const Request& request){
+    Task* task = new Task;
+    task->request = request;
+    task->submitted = std::chrono::steady_clock::now();
+    task->has_deadline = request.deadline > 0;
+    task->deadline = task->submitted + std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+        std::chrono::duration< double >(request.deadline));
+    task->result.deadline_hit = false;
+    task->request.options.yield_every = slice_nodes;
+    task->request.options.yield = [task](){ return task->yield(); };
+
+    {
+        std::lock_guard< std::mutex > guard(lock);
+        if(!free_stacks.empty()){
+            task->stack = free_stacks.back();
+            free_stacks.pop_back();
+        }
+    }
+    if(task->stack == nullptr) task->stack = new char[TASK_STACK_SIZE];
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack;
+    task->context.uc_stack.ss_size = TASK_STACK_SIZE;
+    task->context.uc_link = nullptr;
+    uintptr_t address = (uintptr_t)task;
+    makecontext(&task->context, (void (*)())run_task, 2, (int)(address >> 32), (int)(address & 0xffffffff));
+
+    {
+        std::lock_guard< std::mutex > guard(lock);
+        enqueue(task);
+        running++;
+    }
+    wake.notify_one();
+}
+
+void Scheduler::work(int worker){
+    bool pinned = pin_worker(cpus, worker);
+    ucontext_t context;
+    std::unique_lock< std::mutex > guard(lock);
+    if(!pinned) pin_failure_count++;
+    while(true){
+        wake.wait(guard, [this](){ return stopping || !queue.empty(); });
+        if(queue.empty()) return;
+        std::pop_heap(queue.begin(), queue.end(), runs_later);
+        Task* task = queue.back();
+        queue.pop_back();
+        slice_count++;
+        guard.unlock();
+
+        //A search whose deadline passed while it waited is only resumed to
+        //return the best move it has, yield telling it to stop. One not yet
+        //started stops at its first node.
+        if(task->expired() && !task->started) task->request.options.yield_every = 1;
+        task->started = true;
+        //runs the search until it yields or ends
+        task->worker = &context;
+        swapcontext(&context, &task->context);
+
+        if(task->finished){
+            finish(task);
+            guard.lock();
+        } else{
+            guard.lock();
+            enqueue(task);
+        }
+    }
+}
+
+void Scheduler::enqueue(Task* task){
+    task->sequence = queued_count++;
+    queue.push_back(task);
+    std::push_heap(queue.begin(), queue.end(), runs_later);
+}
+
+//bucket 0 holds latencies up to a microsecond, bucket b the 16th of a
+//doubling ending at bucket_end(b)
+static const double LATENCY_FIRST = 1e-6;
+static const int LATENCY_STEPS = 16;
+
+int Scheduler::Latencies::bucket(double seconds){
+    if(seconds <= LATENCY_FIRST) return 0;
+    int b = (int)std::ceil(std::log2(seconds / LATENCY_FIRST) * LATENCY_STEPS);
+    return std::min(std::max(b, 1), BUCKETS - 1);
+}
+
+double Scheduler::Latencies::bucket_end(int bucket){
+    return LATENCY_FIRST * std::exp2((double)bucket / LATENCY_STEPS);
+}
+
+Scheduler::Latencies::Latencies(){
+    std::fill(counts, counts + BUCKETS, 0);
+    total = 0;
+    max = 0;
+}
+
+void Scheduler::Latencies::add(double seconds){
+    counts[bucket(seconds)]++;
+    total++;
+    max = std::max(max, seconds);
+}
+
+double Scheduler::Latencies::percentile(double fraction) const{
+    //the end of the bucket holding the index'th latency in order, which
+    //is never past the slowest search
+    if(total == 0) return 0;
+    long index = (long)(fraction * (total - 1) + .5);
+    index = std::min(std::max(index, 0L), total - 1);
+    long seen = 0;
+    for(int bucket = 0; bucket < BUCKETS; bucket++){
+        seen += counts[bucket];
+        if(seen > index) return std::min(bucket_end(bucket), max);
+    }
+    return max;
+}
+
+void Scheduler::finish(Task* task){
+    task->result.latency = std::chrono::duration< double >(std::chrono::steady_clock::now() - task->submitted).count();
+    //done may submit the game's next search
+    if(task->request.done) task->request.done(task->result);
+    {
+        std::lock_guard< std::mutex > guard(lock);
+        latencies.add(task->result.latency);
+        if(task->request.game >= 0) game_latencies[task->request.game].add(task->result.latency);
+        free_stacks.push_back(task->stack);
+        done_count++;
+        running--;
+        if(running == 0) idle.notify_all();
+    }
+    delete task;
+}
+
+void Scheduler::wait_idle(){
+    std::unique_lock< std::mutex > guard(lock);
+    idle.wait(guard, [this](){ return running == 0; });
+}
+
+int Scheduler::queue_depth(){
+    std::lock_guard< std::mutex > guard(lock);
+    return queue.size();
+}
+
+int Scheduler::in_flight(){
+    std::lock_guard< std::mutex > guard(lock);
+    return running;
+}
+
+long Scheduler::completed(){
+    std::lock_guard< std::mutex > guard(lock);
+    return done_count;
+}
+
+long Scheduler::slices(){
+    std::lock_guard< std::mutex > guard(lock);
+    return slice_count;
+}
+
+int Scheduler::pin_failures(){
+    std::lock_guard< std::mutex > guard(lock);
+    return pin_failure_count;
+}
+
+double Scheduler::latency_percentile(double fraction){
+    std::lock_guard< std::mutex > guard(lock);
+    return latencies.percentile(fraction);
+}
+
+double Scheduler::latency_percentile(double fraction, int game){
+    std::lock_guard< std::mutex > guard(lock);
+    std::map< int, Latencies >::const_iterator found = game_latencies.find(game);
+    return (found == game_latencies.end()) ? 0 : found->second.percentile(fraction);
+}
@@ -0,0 +1,108 @@
+//
+// Runs many PlayGame searches on a few threads. Each search gets a stack
+// of its own and gives its thread up every few nodes (see
+// PlayGame::Options::yield), so thousands of games can be in flight and
+// share the threads in turn.
+//
+
+#ifndef TERMINALAPP_SCHEDULER_H
+#define TERMINALAPP_SCHEDULER_H
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "PlayGame.h"
+
+class Scheduler{
+public:
+    struct Result{
+        std::vector< int > move;
+        std::vector< int > next_moves_board;
+        double heuristic_score;
+        long nodes; //children_generated
+        bool deadline_hit; //stopped by the deadline rather than finished
+        double latency; //seconds from submit to the end of the search
+    };
+
+    //One search to run. options.yield and options.yield_every are set by
+    //the scheduler.
+    struct Request{
+        std::vector< int > board;
+        bool player_max;
+        bool algorithm;
+        int heuristic;
+        int depth;
+        PlayGame::Options options;
+        double deadline; //seconds after submit to stop searching and play the best move found, 0 for none
+        int game; //game or client the search is for, its latencies are kept apart too; -1 for none
+        std::function< void(const Result&) > done; //called on a worker thread when the search ends
+
+        Request() : player_max(true), algorithm(1), heuristic(3), depth(6), deadline(0), game(-1){}
+    };
+
+    //threads run the searches, each for slice_nodes nodes at a time,
+    //worker t pinned to cpus[t % cpus.size()] unless cpus is empty
+    Scheduler(int threads, long slice_nodes, const std::vector< int >& cpus = std::vector< int >());
+    ~Scheduler(); //waits for every search to end
+
+    void submit(const Request& request);
+    void wait_idle(); //returns once no search is left
+
+    int queue_depth(); //searches waiting for a thread
+    int in_flight(); //searches submitted and not yet done
+    long completed();
+    long slices(); //times a search was given a thread
+    int pin_failures(); //workers left unpinned as their CPU couldn't be used
+    //latency below which the given fraction (0 to 1) of searches ended,
+    //to within a bucket of the latency histogram (about 4%)
+    double latency_percentile(double fraction);
+    //the same over the searches of one Request::game, 0 before its first
+    double latency_percentile(double fraction, int game);
+
+    struct Task;
+private:
+    void work(int worker);
+    void enqueue(Task* task); //with lock held
+    void finish(Task* task);
+
+    //Latencies counted in buckets growing 16 to a doubling from a
+    //microsecond, so the memory and the time to read a percentile stay
+    //the same however long the scheduler runs. The last bucket takes
+    //anything past its start (about 4.5 hours).
+    struct Latencies{
+        static const int BUCKETS = 16 * 34;
+        long counts[BUCKETS];
+        long total;
+        double max;
+
+        Latencies();
+        void add(double seconds);
+        double percentile(double fraction) const;
+        static int bucket(double seconds);
+        static double bucket_end(int bucket);
+    };
+
+    std::vector< std::thread > workers;
+    //Runnable searches, a heap with the earliest deadline on top. Searches
+    //without a deadline come after all with one, and ties go first come
+    //first served, a search that yields queueing anew behind its equals.
+    std::vector< Task* > queue;
+    long queued_count; //orders ties in the queue
+    std::mutex lock;
+    std::condition_variable wake; //work was queued or stopping was set
+    std::condition_variable idle; //in_flight went to 0
+    bool stopping;
+    int running;
+    long done_count;
+    long slice_count;
+    long slice_nodes;
+    int pin_failure_count;
+    Latencies latencies; //of every search ended
+    std::map< int, Latencies > game_latencies; //by Request::game
+    std::vector< char* > free_stacks; //stacks of ended searches, kept for new ones
+    std::vector< int > cpus;
+};
+
+#endif //TERMINALAPP_SCHEDULER_H
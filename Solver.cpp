@@ -0,0 +1,242 @@
+//
+// Settles Kalah(6,6) positions outright, as a win, loss or draw for the
+// side to move, with depth-first proof-number search (df-pn).
+//
+
+#include <chrono>
+#include <algorithm>
+#include "Solver.h"
+#include "PlayGame.h"
+#include "Position.h"
+
+//salts for the four questions, by [player_max][draw_wins]
+static const uint64_t QUESTION_SALT[2][2] = {
+    {0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL},
+    {0x94d049bb133111ebULL, 0x2545f4914f6cdd1dULL}
+};
+
+static uint32_t add_numbers(uint32_t a, uint32_t b, uint32_t infinite){
+    //both are at most infinite, so the sum fits
+    return std::min(a + b, infinite);
+}
+
+Solver::Solver(std::size_t megabytes, long node_limit_parameter){
+    std::size_t wanted = megabytes * 1024 * 1024 / sizeof(Entry);
+    entries = 2;
+    while(entries * 2 <= wanted) entries *= 2;
+    table.reset(new Entry[entries]());
+    mask = (entries - 1) & ~(std::size_t)1;
+    node_limit = node_limit_parameter;
+    nodes = 0;
+}
+
+Solver::Result Solver::solve(const std::vector< int >& board, bool player_max){
+    //First whether the side to move wins. If it doesn't, whether it
+    //draws, which settles a loss as well. A draw needs both proofs, a
+    //loss only the second.
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    nodes = 0;
+    Result result;
+    result.outcome = UNKNOWN;
+    result.proof_size = 0;
+    uint64_t win_disproof = 0;
+    for(int draw_wins = 0; draw_wins < 2; draw_wins++){
+        Question question;
+        question.player_max = player_max;
+        question.draw_wins = draw_wins;
+        question.salt = QUESTION_SALT[player_max][draw_wins];
+        Entry entry;
+        std::vector< int > move;
+        if(settled(board, question, entry.pn, entry.dn)){
+            entry.size = 1;
+        } else{
+            entry.key = position_hash(board, player_max) ^ question.salt;
+            if(entry.key == 0) entry.key = 1;
+            if(!lookup(entry.key, entry)){
+                entry.pn = 1;
+                entry.dn = 1;
+                entry.size = 0;
+            }
+            mid(board, player_max, entry.key, question, INFINITE, INFINITE, entry, &move);
+        }
+        if(entry.pn == 0){
+            result.outcome = draw_wins ? DRAW : WIN;
+            result.move = move;
+            result.proof_size = entry.size + win_disproof;
+            break;
+        }
+        if(entry.dn != 0) break; //out of nodes
+        win_disproof = entry.size;
+        if(draw_wins){
+            result.outcome = LOSS;
+            result.proof_size = entry.size;
+        }
+    }
+    result.nodes = nodes;
+    result.seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void Solver::mid(const std::vector< int >& board, bool player_max, uint64_t key, const Question& question,
+                 uint32_t pn_threshold, uint32_t dn_threshold, Entry& entry, std::vector< int >* move){
+    //At the root player's turns (or nodes) one proven move proves the
+    //node, at the other player's (and nodes) every move has to be.
+    bool or_node = player_max == question.player_max;
+    long nodes_before = nodes;
+    nodes++;
+
+    PlayGame::Node state;
+    state.board = board;
+    state.player_max = player_max;
+    PlayGame::legal_actions(state);
+    std::vector< Child > made(state.action.size());
+    for(int i = 0; i < made.size(); i++){
+        Child& child = made[i];
+        child.action = state.action[i];
+        child.board = board;
+        sow(child.board, player_max, child.action);
+        child.size = 1;
+        child.key = 0;
+        if(settled(child.board, question, child.pn, child.dn)) continue;
+        child.key = position_hash(child.board, !player_max) ^ question.salt;
+        if(child.key == 0) child.key = 1;
+        Entry stored;
+        if(lookup(child.key, stored)){
+            child.pn = stored.pn;
+            child.dn = stored.dn;
+            child.size = stored.size;
+        } else{
+            child.pn = 1;
+            child.dn = 1;
+            child.size = 0;
+        }
+    }
+
+    int best = 0;
+    while(true){
+        //the node's numbers from its children's, and the child to search:
+        //the cheapest to prove at or nodes, to disprove at and nodes
+        uint32_t pn = or_node ? INFINITE : 0;
+        uint32_t dn = or_node ? 0 : INFINITE;
+        uint32_t second = INFINITE;
+        best = 0;
+        for(int i = 0; i < made.size(); i++){
+            uint32_t cheapest = or_node ? made[i].pn : made[i].dn;
+            uint32_t best_so_far = or_node ? made[best].pn : made[best].dn;
+            if(i > 0 && cheapest < best_so_far){
+                second = best_so_far;
+                best = i;
+            } else if(i > 0 && cheapest < second){
+                second = cheapest;
+            }
+            if(or_node){
+                pn = std::min(pn, made[i].pn);
+                dn = add_numbers(dn, made[i].dn, INFINITE);
+            } else{
+                pn = add_numbers(pn, made[i].pn, INFINITE);
+                dn = std::min(dn, made[i].dn);
+            }
+        }
+        if(pn == 0) dn = INFINITE;
+        if(dn == 0) pn = INFINITE;
+        entry.pn = pn;
+        entry.dn = dn;
+        if(pn >= pn_threshold || dn >= dn_threshold) break;
+        if(node_limit > 0 && nodes >= node_limit) break;
+
+        //the child may use what is left of the node's thresholds, but no
+        //more than would make the second best child cheaper
+        Child& child = made[best];
+        uint32_t child_pn_threshold, child_dn_threshold;
+        if(or_node){
+            child_pn_threshold = std::min(pn_threshold, second + 1);
+            child_dn_threshold = (dn_threshold == INFINITE) ? INFINITE : dn_threshold - dn + child.dn;
+        } else{
+            child_dn_threshold = std::min(dn_threshold, second + 1);
+            child_pn_threshold = (pn_threshold == INFINITE) ? INFINITE : pn_threshold - pn + child.pn;
+        }
+        Entry searched;
+        searched.pn = child.pn;
+        searched.dn = child.dn;
+        searched.size = child.size;
+        mid(child.board, !player_max, child.key, question, child_pn_threshold, child_dn_threshold, searched, nullptr);
+        child.pn = searched.pn;
+        child.dn = searched.dn;
+        child.size = searched.size;
+    }
+
+    //A settled node's size is that of its proof tree: one child's if a
+    //single move settles it, every child's if all of them have to.
+    if(entry.pn == 0 || entry.dn == 0){
+        bool one_child = or_node == (entry.pn == 0);
+        uint64_t size = one_child ? UINT64_MAX : 0;
+        for(int i = 0; i < made.size(); i++){
+            bool settles = (entry.pn == 0) ? made[i].pn == 0 : made[i].dn == 0;
+            if(!settles) continue;
+            if(!one_child){
+                size += made[i].size;
+            } else if(made[i].size < size){
+                size = made[i].size;
+                best = i;
+            }
+        }
+        entry.size = size + 1;
+        if(move != nullptr && entry.pn == 0 && or_node) *move = made[best].action;
+    } else{
+        entry.size += nodes - nodes_before;
+    }
+    entry.key = key;
+    store(entry);
+}
+
+bool Solver::settled(const std::vector< int >& board, const Question& question, uint32_t& pn, uint32_t& dn){
+    bool proven;
+    bool max_empty = true;
+    bool min_empty = true;
+    for(int i = 0; i < 6; i++){
+        if(board[i] != 0) max_empty = false;
+        if(board[i + 7] != 0) min_empty = false;
+    }
+    int own = board[question.player_max ? 6 : 13];
+    int other = board[question.player_max ? 13 : 6];
+    if(terminal_board(board) || max_empty || min_empty){
+        double score = exact_score(board, 0);
+        if(!question.player_max) score = -score;
+        proven = score > 0 || (question.draw_wins && score == 0);
+    } else if(question.draw_wins && own >= 36){
+        proven = true; //seeds never leave a kalah, so it can't lose
+    } else if(!question.draw_wins && other >= 36){
+        proven = false; //nor can the other player
+    } else{
+        return false;
+    }
+    pn = proven ? 0 : INFINITE;
+    dn = proven ? INFINITE : 0;
+    return true;
+}
+
+bool Solver::lookup(uint64_t key, Entry& entry){
+    std::size_t index = key & mask;
+    for(int way = 0; way < 2; way++){
+        if(table[index + way].key == key){
+            entry = table[index + way];
+            return true;
+        }
+    }
+    return false;
+}
+
+void Solver::store(const Entry& entry){
+    //the same position is overwritten, else an empty slot is used, else
+    //the entry with less work (or the smaller proof) behind it goes
+    std::size_t index = entry.key & mask;
+    std::size_t slot = index;
+    for(int way = 0; way < 2; way++){
+        if(table[index + way].key == entry.key || table[index + way].key == 0){
+            slot = index + way;
+            break;
+        }
+        if(table[index + way].size < table[slot].size) slot = index + way;
+    }
+    table[slot] = entry;
+}
@@ -0,0 +1,86 @@
+//
+// Settles Kalah(6,6) positions outright, as a win, loss or draw for the
+// side to move, with depth-first proof-number search (df-pn).
+//
+
+#ifndef TERMINALAPP_SOLVER_H
+#define TERMINALAPP_SOLVER_H
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+//Proof-number search grows the tree where a proof or disproof looks
+//cheapest: a position is proven once one move (for the side being
+//solved) or every move (for the other side) is, so lopsided positions
+//are settled long before a fixed-depth search would see their end.
+//Moves are whole turns, as PlayGame::legal_actions gives them, played
+//with sow. Positions can't repeat in Kalah, as every turn adds to a
+//kalah or moves the player's seeds on towards it, so no cycle handling
+//is needed. The table is fixed in size; entries that don't fit are
+//dropped and searched again if they are needed.
+class Solver{
+public:
+    enum Outcome{ LOSS = -1, DRAW = 0, WIN = 1, UNKNOWN = 2 }; //for the side to move
+
+    struct Result{
+        Outcome outcome;
+        std::vector< int > move; //a move keeping the outcome, empty for a loss or unknown
+        uint64_t proof_size; //positions in the proof tree, counted once per path to them
+        long nodes; //positions expanded
+        double seconds;
+    };
+
+    //megabytes is rounded down to a power of two number of entries,
+    //node_limit stops a solve as UNKNOWN after that many expansions, 0 for none
+    Solver(std::size_t megabytes, long node_limit);
+
+    Result solve(const std::vector< int >& board, bool player_max);
+
+private:
+    //proof and disproof numbers, INFINITE once the other is 0
+    static const uint32_t INFINITE = 0x7fffffff;
+
+    struct Entry{
+        uint64_t key; //0 for an empty slot
+        uint32_t pn;
+        uint32_t dn;
+        uint64_t size; //proof_size once pn or dn is 0, else expansions spent on it
+    };
+
+    //One question about the root: can its side to move win (or, with
+    //draw_wins, at least draw). pn is for a yes.
+    struct Question{
+        bool player_max; //side to move at the root
+        bool draw_wins;
+        uint64_t salt; //keeps the two questions' entries apart
+    };
+
+    struct Child{
+        std::vector< int > board;
+        std::vector< int > action;
+        uint64_t key;
+        uint32_t pn;
+        uint32_t dn;
+        uint64_t size;
+    };
+
+    //Nagai's multiple iterative deepening: searches below board until
+    //its pn or dn reaches the threshold, leaving them in entry. move, if
+    //given, is set to the move proving the question at board.
+    void mid(const std::vector< int >& board, bool player_max, uint64_t key, const Question& question,
+             uint32_t pn_threshold, uint32_t dn_threshold, Entry& entry, std::vector< int >* move);
+    //true if board answers question without a search, setting pn and dn
+    bool settled(const std::vector< int >& board, const Question& question, uint32_t& pn, uint32_t& dn);
+
+    bool lookup(uint64_t key, Entry& entry);
+    void store(const Entry& entry);
+
+    std::unique_ptr< Entry[] > table;
+    std::size_t entries;
+    std::size_t mask; //picks the first entry of a bucket of two
+    long node_limit;
+    long nodes;
+};
+
+#endif //TERMINALAPP_SOLVER_H
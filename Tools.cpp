@@ -0,0 +1,927 @@
+//
+// Command line tools built around PlayGame: benchmarks, stress tests and
+// anything else that plays games without the console output of main.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include "Tools.h"
+#include "TranspositionTable.h"
+#include "PackedBoard.h"
+#include "DiagLog.h"
+#include "Scheduler.h"
+#include "Reductions.h"
+#include "Solver.h"
+#include "Regression.h"
+#include "Affinity.h"
+
+//CPUs the worker threads of the tools are pinned to, from --cpus=, empty to
+//leave them unpinned
+static std::vector< int > worker_cpus;
+
+//pins worker t of a tool's pool to worker_cpus, saying so once if a CPU
+//of the list can't be used
+static void pin_tool_worker(int t){
+    static std::atomic< bool > warned(false);
+    if(!pin_worker(worker_cpus, t) && !warned.exchange(true)){
+        std::cout << "Can't pin worker " << t << " to CPU " << worker_cpus[t % worker_cpus.size()]
+                  << ", it runs unpinned." << std::endl;
+    }
+}
+
+GameRecord play_game(const PlayerSettings players[2], std::vector< int > board, bool player_max){
+    GameRecord record;
+    record.moves = 0;
+    record.nodes = 0;
+    record.table_probes = 0;
+    record.table_hits = 0;
+    record.seconds[0] = 0;
+    record.seconds[1] = 0;
+    while(!terminal_board(board)){
+        const PlayerSettings& player = players[player_max];
+        if(player.options.table != nullptr) player.options.table->new_search();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        PlayGame next_move(board, player.algorithm, player_max, player.heuristic, player.depth, player.options);
+        record.seconds[player_max] += std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+        record.nodes += next_move.children_generated;
+        record.table_probes += next_move.table_probes;
+        record.table_hits += next_move.table_hits;
+        record.moves++;
+        board = next_move.next_moves_board;
+        player_max = !player_max;
+    }
+    record.board = board;
+    return record;
+}
+
+std::vector< int > random_opening(int plies, unsigned seed, bool& player_max){
+    std::mt19937 random(seed);
+    std::vector< int > board = PlayGame::starting_board();
+    player_max = true;
+    for(int i = 0; i < plies && !terminal_board(board); i++){
+        PlayGame::Node state;
+        state.board = board;
+        state.player_max = player_max;
+        PlayGame::legal_actions(state);
+        sow(board, player_max, state.action[random() % state.action.size()]);
+        player_max = !player_max;
+    }
+    return board;
+}
+
+static int board_seeds(const std::vector< int >& board){
+    int seeds = 0;
+    for(int i = 0; i < 14; i++) seeds += board[i];
+    return seeds;
+}
+
+/******************************************************************************
+ *  Transposition table stress test and scaling benchmark
+ *****************************************************************************/
+
+//Synthetic entries are a function of their key, so a probe that returns
+//anything else means two stores were mixed together.
+static TranspositionTable::Entry stress_entry(uint64_t key){
+    TranspositionTable::Entry entry;
+    entry.value = (double)(key & 0xffff);
+    entry.depth = (int)(key >> 16) & 0x3f;
+    entry.bound = (TranspositionTable::Bound)((key >> 22) % 3);
+    entry.best = (int)(key >> 24) & 0x7f;
+    return entry;
+}
+
+static uint64_t stress_key(uint64_t i){
+    uint64_t z = i * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    return z ^ (z >> 31);
+}
+
+static int tt_stress(int threads, double seconds){
+    //First every thread hammers a small table with synthetic entries from
+    //a shared key range, then they play full games on one table. Build
+    //with -fsanitize=thread to have the race detector watch both.
+    TranspositionTable table(1);
+    std::atomic< long > stores(0), probes(0), hits(0), corrupt(0);
+    std::atomic< bool > stop(false);
+    std::vector< std::thread > workers;
+    for(int t = 0; t < threads; t++){
+        workers.push_back(std::thread([&, t](){
+            pin_tool_worker(t);
+            std::mt19937_64 random(t + 1);
+            long my_stores = 0, my_probes = 0, my_hits = 0, my_corrupt = 0;
+            while(!stop.load(std::memory_order_relaxed)){
+                for(int i = 0; i < 1024; i++){
+                    uint64_t key = stress_key(random() % (table.size() * 4));
+                    if(random() & 1){
+                        table.store(key, stress_entry(key));
+                        my_stores++;
+                    } else{
+                        TranspositionTable::Entry found, wanted = stress_entry(key);
+                        my_probes++;
+                        if(table.probe(key, found)){
+                            my_hits++;
+                            if(found.value != wanted.value || found.depth != wanted.depth
+                               || found.bound != wanted.bound || found.best != wanted.best) my_corrupt++;
+                        }
+                    }
+                }
+                if(t == 0 && (random() & 0xff) == 0) table.new_search();
+            }
+            stores += my_stores;
+            probes += my_probes;
+            hits += my_hits;
+            corrupt += my_corrupt;
+        }));
+    }
+    std::this_thread::sleep_for(std::chrono::duration< double >(seconds / 2));
+    stop = true;
+    for(int t = 0; t < threads; t++) workers[t].join();
+    workers.clear();
+    std::cout << "Synthetic: " << stores << " stores, " << probes << " probes, "
+              << hits << " hits, " << corrupt << " corrupt entries." << std::endl;
+
+    TranspositionTable game_table(16);
+    std::atomic< long > games(0), bad_games(0);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+        + std::chrono::duration_cast< std::chrono::steady_clock::duration >(std::chrono::duration< double >(seconds / 2));
+    for(int t = 0; t < threads; t++){
+        workers.push_back(std::thread([&, t](){
+            pin_tool_worker(t);
+            PlayerSettings players[2];
+            players[0].options.table = &game_table;
+            players[1].options.table = &game_table;
+            players[0].heuristic = t % 4;
+            players[1].heuristic = (t + 1) % 4;
+            for(unsigned game = 0; std::chrono::steady_clock::now() < deadline; game++){
+                bool player_max;
+                std::vector< int > board = random_opening(4, t * 7919 + game, player_max);
+                GameRecord record = play_game(players, board, player_max);
+                games++;
+                if(board_seeds(record.board) != 72) bad_games++;
+            }
+        }));
+    }
+    for(int t = 0; t < threads; t++) workers[t].join();
+    std::cout << "Games: " << games << " played, " << bad_games << " ended on a bad board." << std::endl;
+
+    if(corrupt > 0 || bad_games > 0){
+        std::cout << "FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
+
+static int tt_bench(int max_threads, int depth, int games){
+    //Every thread plays its own games from random openings, all sharing
+    //one table, first with 1 thread and then with more up to max_threads.
+    std::cout << "threads,games,nodes,seconds,nodes per second,hit rate,speedup" << std::endl;
+    double single_rate = 0;
+    for(int threads = 1; threads <= max_threads; threads++){
+        TranspositionTable table(64);
+        std::atomic< long > nodes(0), probes(0), hits(0);
+        std::vector< std::thread > workers;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(int t = 0; t < threads; t++){
+            workers.push_back(std::thread([&, t](){
+                pin_tool_worker(t);
+                PlayerSettings players[2];
+                players[0].depth = depth;
+                players[1].depth = depth;
+                players[0].options.table = &table;
+                players[1].options.table = &table;
+                for(int game = 0; game < games; game++){
+                    bool player_max;
+                    std::vector< int > board = random_opening(4, t * 7919 + game, player_max);
+                    GameRecord record = play_game(players, board, player_max);
+                    nodes += record.nodes;
+                    probes += record.table_probes;
+                    hits += record.table_hits;
+                }
+            }));
+        }
+        for(int t = 0; t < threads; t++) workers[t].join();
+        double seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+        double rate = nodes / seconds;
+        if(threads == 1) single_rate = rate;
+        std::cout << threads << "," << threads * games << "," << nodes << "," << seconds << ","
+                  << (long)rate << "," << (probes > 0 ? (double)hits / probes : 0) << ","
+                  << rate / single_rate << std::endl;
+    }
+    return 0;
+}
+
+/******************************************************************************
+ *  Board representation benchmark
+ *****************************************************************************/
+
+struct SowSample{
+    std::vector< int > board;
+    bool player_max;
+    std::vector< int > action;
+};
+
+static int board_bench(int samples){
+    //Collects positions and moves from random playouts, then times the
+    //std::vector< int > board against PackedBoard on the same work, first
+    //playing the moves and then testing for the end of the game.
+    std::vector< SowSample > work;
+    std::mt19937 random(12345);
+    while(work.size() < samples){
+        bool player_max;
+        std::vector< int > board = random_opening(0, 0, player_max);
+        while(!terminal_board(board) && work.size() < samples){
+            PlayGame::Node state;
+            state.board = board;
+            state.player_max = player_max;
+            PlayGame::legal_actions(state);
+            SowSample sample;
+            sample.board = board;
+            sample.player_max = player_max;
+            sample.action = state.action[random() % state.action.size()];
+            work.push_back(sample);
+            sow(board, player_max, sample.action);
+            player_max = !player_max;
+        }
+    }
+    std::vector< PackedBoard > packed;
+    for(int i = 0; i < work.size(); i++) packed.push_back(PackedBoard(work[i].board));
+
+    //both must agree before their times mean anything
+    int mismatches = 0;
+    for(int i = 0; i < work.size(); i++){
+        std::vector< int > array_board = work[i].board;
+        PackedBoard packed_board = packed[i];
+        int array_captured = sow(array_board, work[i].player_max, work[i].action);
+        int packed_captured = packed_board.sow(work[i].player_max, work[i].action);
+        if(!(PackedBoard(array_board) == packed_board) || array_captured != packed_captured
+           || terminal_board(array_board) != packed_board.terminal()) mismatches++;
+    }
+
+    const int rounds = 20;
+    long checksum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int r = 0; r < rounds; r++){
+        for(int i = 0; i < work.size(); i++){
+            std::vector< int > array_board = work[i].board;
+            checksum += sow(array_board, work[i].player_max, work[i].action);
+            checksum += array_board[6];
+        }
+    }
+    double array_sow = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for(int r = 0; r < rounds; r++){
+        for(int i = 0; i < work.size(); i++){
+            PackedBoard packed_board = packed[i];
+            checksum += packed_board.sow(work[i].player_max, work[i].action);
+            checksum += packed_board.jar(6);
+        }
+    }
+    double packed_sow = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for(int r = 0; r < rounds; r++){
+        for(int i = 0; i < work.size(); i++) checksum += terminal_board(work[i].board);
+    }
+    double array_terminal = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for(int r = 0; r < rounds; r++){
+        for(int i = 0; i < work.size(); i++) checksum += packed[i].terminal();
+    }
+    double packed_terminal = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+
+    double per_op = 1e9 / ((double)rounds * work.size());
+    std::cout << "representation,sow ns,terminal ns" << std::endl;
+    std::cout << "array," << array_sow * per_op << "," << array_terminal * per_op << std::endl;
+    std::cout << "packed," << packed_sow * per_op << "," << packed_terminal * per_op << std::endl;
+    std::cout << work.size() << " moves, " << mismatches << " mismatches (checksum " << checksum << ")" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+/******************************************************************************
+ *  Self-play tuning of the heuristic weights
+ *****************************************************************************/
+
+//the weights (numbered as in Weights.h) a heuristic uses
+static std::vector< int > tuned_weights(int heuristic){
+    std::vector< int > tuned;
+    if(heuristic == 0) tuned.push_back(0);
+    if(heuristic == 1) tuned.push_back(1);
+    if(heuristic == 2){
+        tuned.push_back(2);
+        tuned.push_back(3);
+    }
+    return tuned;
+}
+
+//how far a weight is moved to test it, before the gains shrink it
+static double weight_scale(int index){
+    static const double scales[WEIGHT_COUNT] = {1, .05, .2, .05};
+    return scales[index];
+}
+
+static double match_score(const PlayerSettings& plus, const PlayerSettings& minus, int openings, unsigned seed, int threads){
+    //Plays every opening twice, plus taking each side once, with the
+    //games shared out among the threads. Returns plus's share of the
+    //points, counting a win as 1 and a draw as a half.
+    std::atomic< int > next_game(0);
+    std::atomic< long > half_points(0);
+    std::vector< std::thread > workers;
+    for(int t = 0; t < threads; t++){
+        workers.push_back(std::thread([&, t](){
+            pin_tool_worker(t);
+            for(int game = next_game++; game < 2 * openings; game = next_game++){
+                bool player_max;
+                std::vector< int > board = random_opening(4, seed + game / 2, player_max);
+                bool plus_max = game % 2 == 0;
+                PlayerSettings players[2];
+                players[1] = plus_max ? plus : minus;
+                players[0] = plus_max ? minus : plus;
+                GameRecord record = play_game(players, board, player_max);
+                int margin = record.board[6] - record.board[13];
+                if(!plus_max) margin = -margin;
+                half_points += (margin > 0) ? 2 : (margin == 0) ? 1 : 0;
+            }
+        }));
+    }
+    for(int t = 0; t < threads; t++) workers[t].join();
+    return half_points / (4.0 * openings);
+}
+
+static int tune(int heuristic, int iterations, int openings, int depth, int threads, const std::string& file_name){
+    //SPSA: each iteration moves every weight of the heuristic up or down
+    //at random, plays the two resulting sets of weights against each
+    //other and steps towards the one which scored better. The weights
+    //are saved after every iteration, so a run can be stopped and picked
+    //up again from the file.
+    std::vector< int > tuned = tuned_weights(heuristic);
+    if(tuned.empty()){
+        std::cout << "The simple heuristic has no weights to tune." << std::endl;
+        return 1;
+    }
+    Weights weights;
+    if(load_weights(file_name, weights)) std::cout << "Starting from " << file_name << std::endl;
+    std::mt19937 random(2017);
+    std::cout << "iteration,score";
+    for(int i = 0; i < tuned.size(); i++) std::cout << "," << weight_name(tuned[i]);
+    std::cout << std::endl;
+    for(int k = 1; k <= iterations; k++){
+        //the usual SPSA gain sequences, test steps shrink slower than moves
+        double test_gain = 1 / std::pow(k, .101);
+        double move_gain = 2 / std::pow(k + iterations / 10.0, .602);
+        PlayerSettings plus, minus;
+        plus.heuristic = minus.heuristic = heuristic;
+        plus.depth = minus.depth = depth;
+        plus.options.weights = minus.options.weights = weights;
+        std::vector< int > delta;
+        for(int i = 0; i < tuned.size(); i++){
+            delta.push_back((random() & 1) ? 1 : -1);
+            double step = test_gain * weight_scale(tuned[i]) * delta[i];
+            weight(plus.options.weights, tuned[i]) += step;
+            weight(minus.options.weights, tuned[i]) -= step;
+        }
+        double score = match_score(plus, minus, openings, k * 100003u, threads);
+        //2 * score - 1 is plus's points less minus's, as a share of the games
+        std::cout << k << "," << score;
+        for(int i = 0; i < tuned.size(); i++){
+            double& tuned_weight = weight(weights, tuned[i]);
+            tuned_weight += move_gain * weight_scale(tuned[i]) * (2 * score - 1) / (2 * test_gain) * delta[i];
+            if(tuned_weight < 0) tuned_weight = 0;
+            std::cout << "," << tuned_weight;
+        }
+        std::cout << std::endl;
+        if(!save_weights(file_name, weights)){
+            std::cout << "Can't write " << file_name << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************
+ *  Synthetic load on the scheduler
+ *****************************************************************************/
+
+//A game between the engine (max) and a stand-in for a person, who
+//answers at once with a random move
+struct ServedGame{
+    std::vector< int > board;
+    bool player_max;
+    std::mt19937 random;
+    int heuristic;
+};
+
+static int serve_bench(int games, int threads, long slice_nodes, double deadline, int depth, double seconds){
+    //Keeps games searches in flight: whenever the engine's move comes
+    //back the other side replies and the next search is submitted, and
+    //a finished game starts over from a new opening. Prints the state of
+    //the scheduler every second.
+    Scheduler scheduler(threads, slice_nodes, worker_cpus);
+    std::vector< ServedGame > served(games);
+    std::atomic< bool > stop(false);
+    std::atomic< long > finished_games(0), deadlines_hit(0), nodes(0);
+    std::function< void(int) > submit_move = [&](int g){
+        ServedGame& game = served[g];
+        Scheduler::Request request;
+        request.board = game.board;
+        request.player_max = game.player_max;
+        request.heuristic = game.heuristic;
+        request.depth = depth;
+        request.deadline = deadline;
+        request.game = g;
+        request.done = [&, g](const Scheduler::Result& result){
+            ServedGame& game = served[g];
+            nodes += result.nodes;
+            if(result.deadline_hit) deadlines_hit++;
+            game.board = result.next_moves_board;
+            game.player_max = !game.player_max;
+            if(!terminal_board(game.board)){
+                PlayGame::Node state;
+                state.board = game.board;
+                state.player_max = game.player_max;
+                PlayGame::legal_actions(state);
+                sow(game.board, game.player_max, state.action[game.random() % state.action.size()]);
+                game.player_max = !game.player_max;
+            }
+            if(terminal_board(game.board)){
+                finished_games++;
+                game.board = random_opening(2, game.random(), game.player_max);
+            }
+            if(!stop) submit_move(g);
+        };
+        scheduler.submit(request);
+    };
+    for(int g = 0; g < games; g++){
+        served[g].random.seed(g + 1);
+        served[g].heuristic = g % 4;
+        served[g].board = random_opening(2, served[g].random(), served[g].player_max);
+        //the opening may leave the other side to move first
+        if(!served[g].player_max){
+            PlayGame::Node state;
+            state.board = served[g].board;
+            state.player_max = false;
+            PlayGame::legal_actions(state);
+            sow(served[g].board, false, state.action[served[g].random() % state.action.size()]);
+            served[g].player_max = true;
+        }
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int g = 0; g < games; g++) submit_move(g);
+
+    std::cout << "seconds,in flight,queue depth,searches,slices,p50 latency,p90 latency,p99 latency" << std::endl;
+    for(int second = 1; second <= seconds; second++){
+        std::this_thread::sleep_until(start + std::chrono::seconds(second));
+        std::cout << second << "," << scheduler.in_flight() << "," << scheduler.queue_depth() << ","
+                  << scheduler.completed() << "," << scheduler.slices() << ","
+                  << scheduler.latency_percentile(.5) << "," << scheduler.latency_percentile(.9) << ","
+                  << scheduler.latency_percentile(.99) << std::endl;
+    }
+    stop = true;
+    scheduler.wait_idle();
+    double elapsed = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    std::cout << scheduler.completed() << " searches (" << (long)(nodes / elapsed) << " nodes per second), "
+              << finished_games << " games finished, " << deadlines_hit << " deadlines hit." << std::endl;
+    std::cout << "Latency p50 " << scheduler.latency_percentile(.5) << " p90 " << scheduler.latency_percentile(.9)
+              << " p99 " << scheduler.latency_percentile(.99) << " max " << scheduler.latency_percentile(1)
+              << " seconds." << std::endl;
+    //the spread between games shows whether some wait much longer than others
+    double best_p99 = 0, worst_p99 = 0;
+    for(int g = 0; g < games; g++){
+        double p99 = scheduler.latency_percentile(.99, g);
+        if(g == 0 || p99 < best_p99) best_p99 = p99;
+        worst_p99 = std::max(worst_p99, p99);
+    }
+    std::cout << "Per game p99 from " << best_p99 << " to " << worst_p99 << " seconds." << std::endl;
+    if(scheduler.pin_failures() > 0){
+        std::cout << scheduler.pin_failures() << " workers couldn't be pinned to --cpus and ran unpinned." << std::endl;
+    }
+    return 0;
+}
+
+/******************************************************************************
+ *  Late move reductions match
+ *****************************************************************************/
+
+static int reductions_match(int openings, int depth, int heuristic, const std::string& file_name){
+    //The engine with reductions plays the plain one at the same depth
+    //and then one to three plies deeper. Each opening is played from
+    //both sides, one game at a time so the times are comparable. Where
+    //the time per move is about the plain engine's, the score shows
+    //what the reductions are worth at equal time.
+    Reductions reductions;
+    if(!file_name.empty() && !load_reductions(file_name, reductions)){
+        std::cout << "Can't read reductions from " << file_name << std::endl;
+        return 1;
+    }
+    std::cout << "depth,reduced depth,score,plain seconds per move,reduced seconds per move,time ratio" << std::endl;
+    for(int extra = 0; extra <= 3; extra++){
+        PlayerSettings plain, reduced;
+        plain.heuristic = heuristic;
+        plain.depth = depth;
+        reduced = plain;
+        reduced.depth = depth + extra;
+        reduced.options.reductions = &reductions;
+        long half_points = 0;
+        double seconds[2] = {0, 0}; //plain, reduced
+        int moves[2] = {0, 0};
+        for(int game = 0; game < 2 * openings; game++){
+            bool player_max;
+            std::vector< int > board = random_opening(4, 1000 + game / 2, player_max);
+            bool reduced_max = game % 2 == 0;
+            PlayerSettings players[2];
+            players[1] = reduced_max ? reduced : plain;
+            players[0] = reduced_max ? plain : reduced;
+            GameRecord record = play_game(players, board, player_max);
+            int margin = record.board[6] - record.board[13];
+            if(!reduced_max) margin = -margin;
+            half_points += (margin > 0) ? 2 : (margin == 0) ? 1 : 0;
+            seconds[0] += record.seconds[!reduced_max];
+            seconds[1] += record.seconds[reduced_max];
+            //max moves first unless the opening left min to move
+            int max_moves = (record.moves + (player_max ? 1 : 0)) / 2;
+            int max_share = reduced_max ? max_moves : record.moves - max_moves;
+            moves[1] += max_share;
+            moves[0] += record.moves - max_share;
+        }
+        double plain_time = seconds[0] / std::max(moves[0], 1);
+        double reduced_time = seconds[1] / std::max(moves[1], 1);
+        std::cout << depth << "," << depth + extra << "," << half_points / (4.0 * openings) << ","
+                  << plain_time << "," << reduced_time << "," << reduced_time / plain_time << std::endl;
+    }
+    return 0;
+}
+
+/******************************************************************************
+ *  Solver
+ *****************************************************************************/
+
+bool parse_position(const std::string& text, std::vector< int >& board, bool& player_max){
+    std::istringstream fields(text);
+    board.assign(14, 0);
+    int seeds = 0;
+    for(int i = 0; i < 14; i++){
+        if(!(fields >> board[i]) || board[i] < 0) return false;
+        seeds += board[i];
+    }
+    int player;
+    if(!(fields >> player) || (player != 0 && player != 1)) return false;
+    player_max = player == 1;
+    return seeds == 72;
+}
+
+static void print_solution(const Solver::Result& result, bool player_max){
+    static const char* outcome_name[4] = {"loss", "draw", "win", "unknown"};
+    std::cout << (player_max ? "max" : "min") << " to move: " << outcome_name[result.outcome + 1];
+    if(!result.move.empty()){
+        std::cout << " playing";
+        for(int i = 0; i < result.move.size(); i++) std::cout << " " << result.move[i];
+    }
+    if(result.outcome != Solver::UNKNOWN) std::cout << ", proof tree of " << result.proof_size << " positions";
+    std::cout << ", " << result.nodes << " expanded in " << result.seconds << " seconds" << std::endl;
+}
+
+static int solve(const std::string& position, std::size_t megabytes, long node_limit){
+    //one position, or with "-" one a line from the standard input
+    Solver solver(megabytes, node_limit);
+    std::vector< int > board;
+    bool player_max;
+    if(position != "-"){
+        if(!parse_position(position, board, player_max)){
+            std::cout << "Bad position: " << position << std::endl;
+            return 1;
+        }
+        print_solution(solver.solve(board, player_max), player_max);
+        return 0;
+    }
+    std::string line;
+    while(std::getline(std::cin, line)){
+        if(line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        if(!parse_position(line, board, player_max)){
+            std::cout << "Bad position: " << line << std::endl;
+            continue;
+        }
+        print_solution(solver.solve(board, player_max), player_max);
+    }
+    return 0;
+}
+
+/******************************************************************************
+ *  Checks of the rules
+ *****************************************************************************/
+
+struct SowCase{
+    const char* name;
+    std::vector< int > board;
+    bool player_max;
+    std::vector< int > action;
+    std::vector< int > expected;
+    int captured;
+};
+
+template< int PITS, int SEEDS >
+static bool check_sow(const SowCase& test){
+    //the engine's sow, and for Kalah(6,6) the packed board's as well
+    std::vector< int > board = test.board;
+    int captured = BasicPlayGame< PITS, SEEDS >::sow(board, test.player_max, test.action);
+    bool passed = board == test.expected && captured == test.captured;
+    if(board.size() == 14){
+        PackedBoard packed(test.board);
+        int packed_captured = packed.sow(test.player_max, test.action);
+        passed = passed && PackedBoard(test.expected) == packed && packed_captured == test.captured;
+    }
+    std::cout << (passed ? "ok      " : "FAILED  ") << test.name << std::endl;
+    return passed;
+}
+
+static bool check_bound(const char* name, double value, TranspositionTable::Bound bound){
+    //A bound has to come back as stored: a lower bound rounded up, or an
+    //upper bound rounded down, cuts off where the search without the
+    //table doesn't, here at the nearest double past the value.
+    TranspositionTable table(1);
+    TranspositionTable::Entry entry, found;
+    entry.value = value;
+    entry.depth = 3;
+    entry.bound = bound;
+    entry.best = 0;
+    table.store(0x123456789abcdefULL, entry);
+    bool passed = table.probe(0x123456789abcdefULL, found) && found.bound == bound;
+    if(bound == TranspositionTable::LOWER) passed = passed && !(found.value >= std::nextafter(value, 1e300));
+    if(bound == TranspositionTable::UPPER) passed = passed && !(found.value <= std::nextafter(value, -1e300));
+    std::cout << (passed ? "ok      " : "FAILED  ") << name << " " << std::setprecision(17) << value
+              << std::setprecision(6) << std::endl;
+    return passed;
+}
+
+static bool check_table(){
+    //Bell's and Coplin's scores are fractions few floats hold exactly
+    bool passed = true;
+    int fractions = 0;
+    for(unsigned seed = 0; seed < 16 && fractions < 4; seed++){
+        bool player_max;
+        std::vector< int > board = random_opening(6, seed, player_max);
+        PlayGame leaf(board, 1, player_max, 1, 1);
+        double value = leaf.heuristic_score;
+        if((double)(float)value == value) continue;
+        fractions++;
+        passed = check_bound("Bell's score kept as a lower bound", value, TranspositionTable::LOWER) && passed;
+        passed = check_bound("Bell's score kept as an upper bound", value, TranspositionTable::UPPER) && passed;
+    }
+    //and the same searches with a table find the same moves and scores
+    for(int heuristic = 1; heuristic <= 2; heuristic++){
+        for(unsigned seed = 0; seed < 32; seed++){
+            bool player_max;
+            std::vector< int > board = random_opening(6, seed, player_max);
+            TranspositionTable table(16);
+            PlayGame::Options options;
+            options.table = &table;
+            PlayGame plain(board, 1, player_max, heuristic, 6);
+            PlayGame tabled(board, 1, player_max, heuristic, 6, options);
+            bool same = plain.move == tabled.move && plain.heuristic_score == tabled.heuristic_score;
+            if(!same){
+                std::cout << "FAILED  heuristic " << heuristic << ", opening " << seed << ": "
+                          << std::setprecision(17) << tabled.heuristic_score << " with a table, "
+                          << plain.heuristic_score << " without" << std::setprecision(6) << std::endl;
+            }
+            passed = same && passed;
+        }
+    }
+    if(passed) std::cout << "ok      depth 6 searches of Bell's and Coplin's the same with a table" << std::endl;
+    return passed;
+}
+
+static int check(){
+    //Kalah(6,6) jars: max's pits 0-5 and kalah 6, min's pits 7-12 and
+    //kalah 13; pit j faces pit 12 - j
+    std::vector< SowCase > cases = {
+        {"last seed in an empty pit of the mover's, across it full: both go to the kalah",
+         {1, 0, 2, 0, 0, 1, 30, 1, 5, 1, 1, 1, 1, 28}, true, {2},
+         {1, 0, 0, 1, 0, 1, 36, 1, 0, 1, 1, 1, 1, 28}, 6},
+        {"last seed in an empty pit of the mover's, across it empty: no capture",
+         {1, 0, 2, 0, 0, 1, 30, 1, 0, 1, 1, 1, 1, 33}, true, {2},
+         {1, 0, 0, 1, 1, 1, 30, 1, 0, 1, 1, 1, 1, 33}, 0},
+        {"last seed in an empty pit of the opponent's: no capture",
+         {1, 1, 1, 1, 2, 3, 30, 1, 0, 1, 1, 1, 1, 28}, true, {5},
+         {1, 1, 1, 1, 2, 0, 31, 2, 1, 1, 1, 1, 1, 28}, 0},
+        {"13 seeds go round the board into the pit they came from and capture",
+         {13, 1, 1, 1, 1, 1, 20, 1, 1, 1, 1, 1, 1, 28}, true, {0},
+         {0, 2, 2, 2, 2, 2, 24, 2, 2, 2, 2, 2, 0, 28}, 3},
+        {"capture after an extra turn",
+         {1, 0, 2, 0, 0, 1, 30, 1, 5, 1, 1, 1, 1, 28}, true, {5, 2},
+         {1, 0, 0, 1, 0, 0, 37, 1, 0, 1, 1, 1, 1, 28}, 6},
+        {"min captures into its own kalah",
+         {1, 4, 1, 1, 1, 1, 28, 1, 1, 2, 1, 0, 1, 29}, false, {9},
+         {1, 0, 1, 1, 1, 1, 28, 1, 1, 0, 2, 0, 1, 34}, 5},
+    };
+    bool passed = true;
+    for(int i = 0; i < cases.size(); i++) passed = check_sow< 6, 6 >(cases[i]) && passed;
+    //Kalah(4,4): max's pits 0-3 and kalah 4, min's pits 5-8 and kalah 9
+    SowCase small = {"Kalah(4,4) capture",
+                     {1, 1, 0, 2, 10, 1, 3, 1, 1, 12}, true, {1},
+                     {1, 0, 0, 2, 14, 1, 0, 1, 1, 12}, 4};
+    passed = check_sow< 4, 4 >(small) && passed;
+    passed = check_table() && passed;
+
+    if(!passed){
+        std::cout << "FAILED" << std::endl;
+        return 1;
+    }
+    std::cout << "PASSED" << std::endl;
+    return 0;
+}
+
+/******************************************************************************
+ *  Pinned against unpinned scaling
+ *****************************************************************************/
+
+static void print_topology(const std::vector< int >& cpus){
+    std::vector< std::vector< int > > nodes(numa_nodes());
+    for(int i = 0; i < cpus.size(); i++){
+        int node = cpu_node(cpus[i]);
+        if(node >= nodes.size()) nodes.resize(node + 1);
+        nodes[node].push_back(cpus[i]);
+    }
+    std::cout << "# " << cpus.size() << " CPUs on " << numa_nodes() << " NUMA node(s)";
+    for(int node = 0; node < nodes.size(); node++){
+        if(!nodes[node].empty()) std::cout << ", node " << node << ": " << cpu_list_text(nodes[node]);
+    }
+    std::cout << std::endl;
+}
+
+static double affinity_run(int threads, int depth, int games, const std::vector< int >& cpus, int& pin_failures){
+    //Every thread plays its own games with a table of its own, made after
+    //the thread is pinned so its pages are on the thread's node. Returns
+    //nodes per second.
+    std::atomic< long > nodes(0);
+    std::atomic< int > failures(0);
+    std::vector< std::thread > workers;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int t = 0; t < threads; t++){
+        workers.push_back(std::thread([&, t](){
+            if(!pin_worker(cpus, t)) failures++;
+            TranspositionTable table(16);
+            PlayerSettings players[2];
+            players[0].depth = depth;
+            players[1].depth = depth;
+            players[0].options.table = &table;
+            players[1].options.table = &table;
+            for(int game = 0; game < games; game++){
+                bool player_max;
+                std::vector< int > board = random_opening(4, t * 7919 + game, player_max);
+                nodes += play_game(players, board, player_max).nodes;
+            }
+        }));
+    }
+    for(int t = 0; t < threads; t++) workers[t].join();
+    pin_failures = failures;
+    return nodes / std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+}
+
+static int affinity_bench(int max_threads, int depth, int games, const std::vector< int >& cpus){
+    //The same games on 1 to max_threads threads, first left to the
+    //operating system and then with worker t pinned to cpus[t % size].
+    //Both runs search the same nodes, so the rates compare their times.
+    print_topology(cpus);
+    std::cout << "threads,unpinned nodes per second,pinned nodes per second,pinned/unpinned,"
+              << "unpinned speedup,pinned speedup,threads not pinned,pinned to" << std::endl;
+    double single_unpinned = 0, single_pinned = 0;
+    for(int threads = 1; threads <= max_threads; threads++){
+        int unused, pin_failures;
+        double unpinned = affinity_run(threads, depth, games, std::vector< int >(), unused);
+        double pinned = affinity_run(threads, depth, games, cpus, pin_failures);
+        if(threads == 1){
+            single_unpinned = unpinned;
+            single_pinned = pinned;
+        }
+        std::vector< int > used;
+        for(int t = 0; t < threads; t++) used.push_back(cpus[t % cpus.size()]);
+        std::sort(used.begin(), used.end());
+        used.erase(std::unique(used.begin(), used.end()), used.end());
+        std::cout << threads << "," << (long)unpinned << "," << (long)pinned << "," << pinned / unpinned << ","
+                  << unpinned / single_unpinned << "," << pinned / single_pinned << "," << pin_failures << ",\""
+                  << cpu_list_text(used) << "\"" << std::endl;
+    }
+    return 0;
+}
+
+/******************************************************************************
+ *  Tool dispatch
+ *****************************************************************************/
+
+int run_tool(int argc, char* argv[]){
+    // ./kalah --tt-stress [threads] [seconds]
+    // ./kalah --tt-bench [max_threads] [depth] [games per thread]
+    // ./kalah --board-bench [moves]
+    // ./kalah --diag-convert diag.bin diag.csv
+    // ./kalah --serve-bench [games] [threads] [slice nodes] [deadline ms] [depth] [seconds]
+    // ./kalah --tune heuristic [iterations] [openings] [depth] [threads] [weights file]
+    // ./kalah --reductions-match [openings] [depth] [heuristic] [reductions file]
+    // ./kalah --solve "j0 ... j13 player"|- [megabytes] [node limit]
+    // ./kalah --regress-corpus [corpus file] [positions per phase]
+    // ./kalah --regress-record [corpus file] [baseline file]
+    // ./kalah --regress [corpus file] [baseline file] [node threshold] [time threshold]
+    // ./kalah --affinity-bench [max_threads] [depth] [games per thread]
+    // ./kalah --check
+    //--cpus=LIST, anywhere after the tool, pins the worker threads of the
+    //thread pools and the scheduler to LIST, as "0-3,8"
+    std::vector< char* > args;
+    for(int i = 0; i < argc; i++){
+        std::string arg = argv[i];
+        if(i > 1 && arg.compare(0, 7, "--cpus=") == 0){
+            if(!parse_cpu_list(arg.substr(7), worker_cpus)){
+                std::cout << "Bad CPU list: " << arg.substr(7) << std::endl;
+                return 1;
+            }
+        } else{
+            args.push_back(argv[i]);
+        }
+    }
+    argc = args.size();
+    argv = args.data();
+    std::string tool = argv[1];
+    int hardware = std::thread::hardware_concurrency();
+    if(hardware < 1) hardware = 1;
+    if(tool == "--tt-stress"){
+        int threads = (argc > 2) ? atoi(argv[2]) : hardware;
+        double seconds = (argc > 3) ? atof(argv[3]) : 10;
+        return tt_stress(threads, seconds);
+    }
+    if(tool == "--tt-bench"){
+        int threads = (argc > 2) ? atoi(argv[2]) : hardware;
+        int depth = (argc > 3) ? atoi(argv[3]) : 7;
+        int games = (argc > 4) ? atoi(argv[4]) : 4;
+        return tt_bench(threads, depth, games);
+    }
+    if(tool == "--board-bench"){
+        int samples = (argc > 2) ? atoi(argv[2]) : 100000;
+        return board_bench(samples);
+    }
+    if(tool == "--serve-bench"){
+        int games = (argc > 2) ? atoi(argv[2]) : 1000;
+        int threads = (argc > 3) ? atoi(argv[3]) : hardware;
+        long slice_nodes = (argc > 4) ? atol(argv[4]) : 1000;
+        double deadline = (argc > 5) ? atof(argv[5]) / 1000 : 0;
+        int depth = (argc > 6) ? atoi(argv[6]) : 6;
+        double seconds = (argc > 7) ? atof(argv[7]) : 10;
+        return serve_bench(games, threads, slice_nodes, deadline, depth, seconds);
+    }
+    if(tool == "--tune" && argc > 2){
+        int iterations = (argc > 3) ? atoi(argv[3]) : 100;
+        int openings = (argc > 4) ? atoi(argv[4]) : 8;
+        int depth = (argc > 5) ? atoi(argv[5]) : 4;
+        int threads = (argc > 6) ? atoi(argv[6]) : hardware;
+        std::string file_name = (argc > 7) ? argv[7] : "weights.txt";
+        return tune(atoi(argv[2]), iterations, openings, depth, threads, file_name);
+    }
+    if(tool == "--reductions-match"){
+        int openings = (argc > 2) ? atoi(argv[2]) : 8;
+        int depth = (argc > 3) ? atoi(argv[3]) : 6;
+        int heuristic = (argc > 4) ? atoi(argv[4]) : 0;
+        std::string file_name = (argc > 5) ? argv[5] : "";
+        return reductions_match(openings, depth, heuristic, file_name);
+    }
+    if(tool == "--solve" && argc > 2){
+        std::size_t megabytes = (argc > 3) ? (std::size_t)atol(argv[3]) : 256;
+        long node_limit = (argc > 4) ? atol(argv[4]) : 0;
+        return solve(argv[2], megabytes, node_limit);
+    }
+    if(tool == "--regress-corpus"){
+        std::string corpus = (argc > 2) ? argv[2] : "regress/corpus.txt";
+        int per_phase = (argc > 3) ? atoi(argv[3]) : 100;
+        return make_corpus(corpus, per_phase);
+    }
+    if(tool == "--regress-record"){
+        std::string corpus = (argc > 2) ? argv[2] : "regress/corpus.txt";
+        std::string baseline = (argc > 3) ? argv[3] : "regress/baseline.txt";
+        return record_baseline(corpus, baseline);
+    }
+    if(tool == "--regress"){
+        std::string corpus = (argc > 2) ? argv[2] : "regress/corpus.txt";
+        std::string baseline = (argc > 3) ? argv[3] : "regress/baseline.txt";
+        double node_threshold = (argc > 4) ? atof(argv[4]) : 1.05;
+        double time_threshold = (argc > 5) ? atof(argv[5]) : 0;
+        return run_regression(corpus, baseline, node_threshold, time_threshold);
+    }
+    if(tool == "--check"){
+        return check();
+    }
+    if(tool == "--affinity-bench"){
+        std::vector< int > cpus = worker_cpus.empty() ? allowed_cpus() : worker_cpus;
+        int threads = (argc > 2) ? atoi(argv[2]) : (int)cpus.size();
+        int depth = (argc > 3) ? atoi(argv[3]) : 7;
+        int games = (argc > 4) ? atoi(argv[4]) : 2;
+        return affinity_bench(threads, depth, games, cpus);
+    }
+    if(tool == "--diag-convert" && argc == 4){
+        return convert_diag(argv[2], argv[3]);
+    }
+    std::cout << "Unknown tool: " << tool << std::endl;
+    return 1;
+}
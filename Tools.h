@@ -0,0 +1,47 @@
+//
+// Command line tools built around PlayGame: benchmarks, stress tests and
+// anything else that plays games without the console output of main.
+//
+
+#ifndef TERMINALAPP_TOOLS_H
+#define TERMINALAPP_TOOLS_H
+#include <vector>
+#include <string>
+#include "PlayGame.h"
+
+//How one side of a game searches, as given to PlayGame's constructor
+struct PlayerSettings{
+    bool algorithm; //0 for Rich + Knight, 1 for Norvig and Luger
+    int heuristic;
+    int depth;
+    PlayGame::Options options;
+
+    PlayerSettings() : algorithm(1), heuristic(3), depth(6){}
+};
+
+struct GameRecord{
+    std::vector< int > board; //final board
+    int moves;
+    long nodes; //children_generated summed over every search
+    long table_probes;
+    long table_hits;
+    double seconds[2]; //time spent searching by players[0] and players[1]
+};
+
+//Plays board out to the end. players[1] is max and players[0] is min,
+//the same order main uses. Tables in the options get new_search each move.
+GameRecord play_game(const PlayerSettings players[2], std::vector< int > board, bool player_max);
+
+//Starting board with plies random moves already played, the same for a
+//given seed. player_max is set to the side to move afterwards.
+std::vector< int > random_opening(int plies, unsigned seed, bool& player_max);
+
+//Reads "j0 j1 ... j13 p", the 14 jars as main numbers them and 1 if max
+//is to move or 0 if min is, ignoring anything after. The seeds have to
+//add up to 72.
+bool parse_position(const std::string& text, std::vector< int >& board, bool& player_max);
+
+//Runs the tool named by argv[1] (which starts with --), returns the exit code
+int run_tool(int argc, char* argv[]);
+
+#endif //TERMINALAPP_TOOLS_H
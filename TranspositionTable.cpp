@@ -0,0 +1,103 @@
+//
+// Transposition table which can be shared by searches on many threads.
+//
+
+#include <cstring>
+#include "TranspositionTable.h"
+
+//data word layout, low bits first:
+//  depth 8 bits, bound 2 bits, best 8 bits (+1), generation 8 bits,
+//  and a set bit so no stored entry is all zero
+
+TranspositionTable::TranspositionTable(std::size_t megabytes){
+    std::size_t wanted = megabytes * 1024 * 1024 / sizeof(Slot);
+    entries = 2;
+    while(entries * 2 <= wanted) entries *= 2;
+    slots.reset(new Slot[entries]);
+    mask = (entries - 1) & ~(std::size_t)1;
+    generation = 0;
+    clear();
+}
+
+uint64_t TranspositionTable::pack(const Entry& entry, unsigned generation){
+    int depth = entry.depth < 0 ? 0 : (entry.depth > 255 ? 255 : entry.depth);
+    uint64_t data = depth;
+    data |= (uint64_t)entry.bound << 8;
+    data |= (uint64_t)((entry.best + 1) & 0xff) << 10;
+    data |= (uint64_t)(generation & 0xff) << 18;
+    data |= (uint64_t)1 << 26;
+    return data;
+}
+
+void TranspositionTable::unpack(uint64_t data, uint64_t value, Entry& entry){
+    std::memcpy(&entry.value, &value, sizeof(value));
+    entry.depth = depth_of(data);
+    entry.bound = (Bound)((data >> 8) & 0x3);
+    entry.best = (int)((data >> 10) & 0xff) - 1;
+}
+
+unsigned TranspositionTable::generation_of(uint64_t data){
+    return (unsigned)(data >> 18) & 0xff;
+}
+
+int TranspositionTable::depth_of(uint64_t data){
+    return (int)data & 0xff;
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry& entry) const{
+    const Slot* bucket = &slots[key & mask];
+    for(int i = 0; i < 2; i++){
+        uint64_t data = bucket[i].data.load(std::memory_order_relaxed);
+        uint64_t value = bucket[i].value.load(std::memory_order_relaxed);
+        uint64_t check = bucket[i].check.load(std::memory_order_relaxed);
+        //a zero data word is an empty slot
+        if(data != 0 && (check ^ data ^ value) == key){
+            unpack(data, value, entry);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, const Entry& entry){
+    Slot* bucket = &slots[key & mask];
+    unsigned current = generation.load(std::memory_order_relaxed) & 0xff;
+    uint64_t data = pack(entry, current);
+    uint64_t value;
+    std::memcpy(&value, &entry.value, sizeof(value));
+
+    //pick the slot: same position first, then the one left by the oldest
+    //search, then the shallower of the two
+    int replace = 0;
+    int best_rank = -1;
+    for(int i = 0; i < 2; i++){
+        uint64_t old_data = bucket[i].data.load(std::memory_order_relaxed);
+        uint64_t old_value = bucket[i].value.load(std::memory_order_relaxed);
+        uint64_t old_check = bucket[i].check.load(std::memory_order_relaxed);
+        if(old_data == 0 || (old_check ^ old_data ^ old_value) == key){
+            replace = i;
+            break;
+        }
+        int age = (int)((current - generation_of(old_data)) & 0xff);
+        int rank = age * 256 + (255 - depth_of(old_data));
+        if(rank > best_rank){
+            best_rank = rank;
+            replace = i;
+        }
+    }
+    bucket[replace].data.store(data, std::memory_order_relaxed);
+    bucket[replace].value.store(value, std::memory_order_relaxed);
+    bucket[replace].check.store(key ^ data ^ value, std::memory_order_relaxed);
+}
+
+void TranspositionTable::new_search(){
+    generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear(){
+    for(std::size_t i = 0; i < entries; i++){
+        slots[i].data.store(0, std::memory_order_relaxed);
+        slots[i].value.store(0, std::memory_order_relaxed);
+        slots[i].check.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,61 @@
+//
+// Transposition table which can be shared by searches on many threads.
+//
+
+#ifndef TERMINALAPP_TRANSPOSITIONTABLE_H
+#define TERMINALAPP_TRANSPOSITIONTABLE_H
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+//Entries are three 64 bit words: the value, the rest of the data, and
+//the key xor'd with both. All are written and read without locks; a
+//reader that sees the words of two different stores gets a key that
+//doesn't match and treats it as a miss. The value is kept as the full
+//double the search gave, since a bound rounded the wrong way (a lower
+//bound up, an upper bound down) would cut off where the search without
+//the table doesn't. Each bucket holds two entries, and a store replaces the entry for
+//the same position, else one left by an older search, else the shallower.
+class TranspositionTable{
+public:
+    enum Bound{ EXACT = 0, LOWER = 1, UPPER = 2 };
+
+    struct Entry{
+        double value; //as seen by max, win scores relative to the stored node
+        int depth; //plies searched below the stored node
+        Bound bound;
+        int best; //index of the best action, -1 if none
+    };
+
+    //megabytes is rounded down to a power of two number of entries
+    explicit TranspositionTable(std::size_t megabytes);
+
+    bool probe(uint64_t key, Entry& entry) const;
+    void store(uint64_t key, const Entry& entry);
+
+    //call before each new move so older entries are replaced first
+    void new_search();
+    void clear();
+
+    std::size_t size() const{ return entries; }
+
+private:
+    struct Slot{
+        std::atomic< uint64_t > check; //key ^ data ^ value
+        std::atomic< uint64_t > data;
+        std::atomic< uint64_t > value; //the double's bits
+    };
+
+    static uint64_t pack(const Entry& entry, unsigned generation);
+    static void unpack(uint64_t data, uint64_t value, Entry& entry);
+    static unsigned generation_of(uint64_t data);
+    static int depth_of(uint64_t data);
+
+    std::unique_ptr< Slot[] > slots;
+    std::size_t entries;
+    std::size_t mask; //picks the first entry of a bucket
+    std::atomic< unsigned > generation;
+};
+
+#endif //TERMINALAPP_TRANSPOSITIONTABLE_H
@@ -0,0 +1,65 @@
+//
+// Board layout of Kalah with PITS pits a side and SEEDS seeds a pit.
+//
+
+#ifndef TERMINALAPP_VARIANT_H
+#define TERMINALAPP_VARIANT_H
+
+//Jars are numbered as in the original Kalah(6,6) engine: max's pits come
+//first, then max's kalah, then min's pits and min's kalah last. For
+//Kalah(6,6) that is pits 0-5, kalah 6, pits 7-12 and kalah 13.
+//The Zobrist keys (Position.cpp), packed moves (DiagLog.h) and table
+//entries are sized for Kalah(6,6), so no variant may be bigger.
+template< int PITS_PARAMETER, int SEEDS_PARAMETER >
+struct KalahVariant{
+    static constexpr int PITS = PITS_PARAMETER;
+    static constexpr int SEEDS = SEEDS_PARAMETER;
+    static constexpr int JARS = 2 * PITS + 2;
+    static constexpr int MAX_KALAH = PITS;
+    static constexpr int MIN_KALAH = 2 * PITS + 1;
+    static constexpr int TOTAL_SEEDS = 2 * PITS * SEEDS;
+    static constexpr int HALF_SEEDS = PITS * SEEDS; //a kalah holding more has won
+
+    static_assert(PITS >= 1 && PITS <= 6 && TOTAL_SEEDS <= 72, "variants can't be bigger than Kalah(6,6)");
+
+    //first pit of a side, the same as the offset of its jars from max's
+    static constexpr int side(bool player_max){ return player_max ? 0 : PITS + 1; }
+    static constexpr int kalah(bool player_max){ return player_max ? MAX_KALAH : MIN_KALAH; }
+
+    //Lookup tables, filled once before main runs
+    struct Tables{
+        int across[JARS]; //pit facing each pit, kalahs face themselves
+        int next[2][JARS]; //[player_max][jar] the jar the player sows into after jar, skipping the other kalah
+
+        Tables(){
+            for(int jar = 0; jar < JARS; jar++){
+                across[jar] = (jar == MAX_KALAH || jar == MIN_KALAH) ? jar : 2 * PITS - jar;
+                for(int player_max = 0; player_max < 2; player_max++){
+                    int following = (jar + 1) % JARS;
+                    if(following == kalah(!player_max)) following = (following + 1) % JARS;
+                    next[player_max][jar] = following;
+                }
+            }
+        }
+    };
+    static const Tables tables;
+};
+
+template< int PITS_PARAMETER, int SEEDS_PARAMETER >
+constexpr int KalahVariant< PITS_PARAMETER, SEEDS_PARAMETER >::PITS;
+template< int PITS_PARAMETER, int SEEDS_PARAMETER >
+constexpr int KalahVariant< PITS_PARAMETER, SEEDS_PARAMETER >::SEEDS;
+template< int PITS_PARAMETER, int SEEDS_PARAMETER >
+constexpr int KalahVariant< PITS_PARAMETER, SEEDS_PARAMETER >::JARS;
+template< int PITS_PARAMETER, int SEEDS_PARAMETER >
+constexpr int KalahVariant< PITS_PARAMETER, SEEDS_PARAMETER >::MAX_KALAH;
+template< int PITS_PARAMETER, int SEEDS_PARAMETER >
+constexpr int KalahVariant< PITS_PARAMETER, SEEDS_PARAMETER >::MIN_KALAH;
+template< int PITS_PARAMETER, int SEEDS_PARAMETER >
+constexpr int KalahVariant< PITS_PARAMETER, SEEDS_PARAMETER >::TOTAL_SEEDS;
+template< int PITS_PARAMETER, int SEEDS_PARAMETER >
+constexpr int KalahVariant< PITS_PARAMETER, SEEDS_PARAMETER >::HALF_SEEDS;
+template< int PITS_PARAMETER, int SEEDS_PARAMETER >
+const typename KalahVariant< PITS_PARAMETER, SEEDS_PARAMETER >::Tables KalahVariant< PITS_PARAMETER, SEEDS_PARAMETER >::tables;
+
+#endif //TERMINALAPP_VARIANT_H
@@ -0,0 +1,72 @@
+//
+// Constants of the heuristics, kept apart from the code so they can be
+// read from a file and tuned (see ./kalah --tune in Tools.cpp).
+//
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include "Weights.h"
+
+const char* weight_name(int index){
+    static const char* names[WEIGHT_COUNT] = {"kalah", "bell", "multi_move", "overflow"};
+    return names[index];
+}
+
+double& weight(Weights& weights, int index){
+    if(index == 0) return weights.kalah;
+    if(index == 1) return weights.bell;
+    if(index == 2) return weights.multi_move;
+    return weights.overflow;
+}
+
+double weight(const Weights& weights, int index){
+    return weight(const_cast< Weights& >(weights), index);
+}
+
+uint64_t weights_hash(const Weights& weights){
+    uint64_t hash = 0;
+    for(int i = 0; i < WEIGHT_COUNT; i++){
+        double value = weight(weights, i);
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        hash = (hash ^ bits) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+bool load_weights(const std::string& file_name, Weights& weights){
+    std::ifstream file(file_name.c_str());
+    if(!file.is_open()) return false;
+    //read into a copy so a bad file leaves weights alone
+    Weights loaded = weights;
+    std::string line;
+    while(std::getline(file, line)){
+        std::size_t comment = line.find('#');
+        if(comment != std::string::npos) line.erase(comment);
+        std::istringstream fields(line);
+        std::string name;
+        double value;
+        if(!(fields >> name)) continue; //blank line
+        if(!(fields >> value)) return false;
+        int index = 0;
+        while(index < WEIGHT_COUNT && name != weight_name(index)) index++;
+        if(index == WEIGHT_COUNT) return false;
+        weight(loaded, index) = value;
+    }
+    weights = loaded;
+    return true;
+}
+
+bool save_weights(const std::string& file_name, const Weights& weights){
+    std::ofstream file(file_name.c_str());
+    if(!file.is_open()) return false;
+    //enough digits that loading gives back the same doubles
+    file << "# Kalah heuristic weights" << std::endl << std::setprecision(17);
+    for(int i = 0; i < WEIGHT_COUNT; i++){
+        file << weight_name(i) << " " << weight(weights, i) << std::endl;
+    }
+    return file.good();
+}
@@ -0,0 +1,36 @@
+//
+// Constants of the heuristics, kept apart from the code so they can be
+// read from a file and tuned (see ./kalah --tune in Tools.cpp).
+//
+
+#ifndef TERMINALAPP_WEIGHTS_H
+#define TERMINALAPP_WEIGHTS_H
+#include <string>
+#include <cstdint>
+
+//The defaults are the values the heuristics were written with.
+struct Weights{
+    double kalah; //alabandi: worth of a seed in a kalah against one in a jar
+    double bell; //bell: worth of a seed which can't reach the opponent's jars
+    double multi_move; //coplin: factor for a move ending in its own kalah
+    double overflow; //coplin: penalty per seed sown onto the opponent's side
+
+    Weights() : kalah(6), bell(.2), multi_move(1.5), overflow(.3){}
+};
+
+//Weights by number, for code which handles all of them alike
+const int WEIGHT_COUNT = 4;
+const char* weight_name(int index);
+double& weight(Weights& weights, int index);
+double weight(const Weights& weights, int index);
+
+//differs for weights that differ, to tell searches using them apart
+uint64_t weights_hash(const Weights& weights);
+
+//Files hold one "name value" pair per line, # starts a comment. Names
+//left out keep their current value. false if the file can't be read or
+//has a line which isn't a known name and a number.
+bool load_weights(const std::string& file_name, Weights& weights);
+bool save_weights(const std::string& file_name, const Weights& weights);
+
+#endif //TERMINALAPP_WEIGHTS_H
@@ -1,8 +1,14 @@
 #include <iostream>
 #include <chrono>
 #include "PlayGame.h"
+#include "TranspositionTable.h"
+#include "EvalCache.h"
+#include "Tools.h"
+#include "DiagLog.h"
+#include "Reductions.h"
 #include <cstdlib>
 #include <fstream>
+#include <string>
 
 // ./a.out alg[1] heu[1] alg[0] heu[0] max_depth[1] max_depth[0] diagout.csv
 //        alg[1]: algorithm for max player, 0 for rich/knight, 1 for norvig/luger
@@ -11,30 +17,62 @@
 //        heu[0]: analogous to heu_max but for min player
 //  max_depth[1]: maximum depth used by max's search tree
 //  max_depth[0]: maximum depth used by min's search tree
-//   diagout.csv: filename for diagnostic output
+//   diagout.csv: filename for diagnostic output, a name ending in .bin
+//                writes a binary log instead (see DiagLog.h), which
+//                ./a.out --diag-convert diagout.bin diagout.csv turns into the CSV
+//
+// Optional settings may follow the diag file, they apply to both players:
+//   --node-limit=N    stop a search after N nodes and play the best finished root move
+//   --memory-limit=M  stop a search once its tree holds roughly M megabytes
+//   --quiescence=N    play out captures and chains past the depth limit, at most N nodes per search
+//   --table=M         share an M megabyte transposition table between the players' searches
+//   --eval-cache=M    keep heuristic values of leaf boards in an M megabyte cache shared by the players
+//   --diag-thread=1   write a binary diag log from a thread of its own
+//   --batch-leaves=1  score the last ply of the tree in batches (alabandi, bell and simple)
+//   --weights=FILE    read the heuristics' constants from FILE, as written by ./a.out --tune
+//   --variant=P,S     play Kalah with P pits of S seeds each, one of 6,6 (the default), 4,4, 5,5 and 6,4
+//   --reductions=FILE search late quiet moves shallower and forcing ones deeper (Norvig and Luger only),
+//                     with the table in FILE (see Reductions.h) or "default" for the built in one
 
 void printboard(std::vector<int> field);
-bool game_over(std::vector< int >);
+template< int PITS, int SEEDS > bool game_over(const std::vector< int >& board);
+//plays a game of Kalah(PITS, SEEDS), see Variant.h
+template< int PITS, int SEEDS >
+void play_kalah(const std::vector< bool >& alg, const std::vector< int >& heu, const std::vector< int >& max_depth,
+                const PlayGame::Options& options, std::ofstream& diag, DiagLog& diag_log);
 void wait_for_user();
 void output_user_info(bool player_max, bool alg, int heuristic, int depth);
+//settings given after the diag file
+struct RunSettings{
+    PlayGame::Options options;
+    std::size_t table_size; //megabytes of transposition table, 0 for none
+    std::size_t eval_cache_size; //megabytes of evaluation cache, 0 for none
+    bool diag_thread; //binary diag log written by its own thread
+    int pits; //the variant played, Kalah(pits, seeds)
+    int seeds;
+    Reductions reductions; //used once options.reductions points here
+
+    RunSettings() : table_size(0), eval_cache_size(0), diag_thread(false), pits(6), seeds(6){}
+};
+bool parse_option(const std::string& arg, RunSettings& settings);
 
 int main(int argc, char* argv[]) {
-    const char *h_name[4];
-    h_name[0] = "Alabandi's H"; h_name[1] = "Bell's H";
-    h_name[2] = "Coplin's H"; h_name[3] = "The simple h";
+    //tools such as --tt-bench are listed in Tools.cpp
+    if(argc > 1 && argv[1][0] == '-' && argv[1][1] == '-') return run_tool(argc, argv);
     std::vector< bool > alg;
     std::vector< int > heu;
     std::vector< int > max_depth;
-    std::ofstream diag;
-    bool is_player_one = 1;
-    if(argc != 8){
+    std::string diag_name;
+    RunSettings settings;
+    PlayGame::Options& options = settings.options;
+    if(argc < 8){
         alg.push_back(1);
         alg.push_back(1);
         heu.push_back(3);
         heu.push_back(3);
         max_depth.push_back(6);
         max_depth.push_back(2);
-        diag.open("test.csv");
+        diag_name = "test.csv";
     } else{
         alg.push_back(atoi(argv[3]));
         alg.push_back(atoi(argv[1]));
@@ -42,57 +80,96 @@ int main(int argc, char* argv[]) {
         heu.push_back(atoi(argv[2]));
         max_depth.push_back(atoi(argv[6]));
         max_depth.push_back(atoi(argv[5]));
-        diag.open(argv[7]);
+        diag_name = argv[7];
+        for(int i = 8; i < argc; i++){
+            if(!parse_option(argv[i], settings)){
+                std::cout << "Bad option: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::unique_ptr< TranspositionTable > table;
+    if(settings.table_size > 0){
+        table.reset(new TranspositionTable(settings.table_size));
+        options.table = table.get();
+    }
+    std::unique_ptr< EvalCache > eval_cache;
+    if(settings.eval_cache_size > 0){
+        eval_cache.reset(new EvalCache(settings.eval_cache_size));
+        options.eval_cache = eval_cache.get();
     }
-    if(diag.is_open()) {
-        diag << "Move Index,Max's Score,Min's Score,Children Generated,Move Made,Time to Run,Board,Path,H Score" << std::endl;
+    //rows are buffered, not flushed one by one
+    std::ofstream diag;
+    DiagLog diag_log;
+    bool binary_diag = diag_name.size() > 4 && diag_name.compare(diag_name.size() - 4, 4, ".bin") == 0;
+    if(binary_diag){
+        diag_log.open(diag_name, settings.diag_thread);
+    } else{
+        diag.open(diag_name.c_str());
+        if(diag.is_open()) write_diag_header(diag);
     }
 
     std::cout << "Kalah game!" << std::endl;
+    if(settings.pits != 6 || settings.seeds != 6){
+        std::cout << settings.pits << " pits a side, " << settings.seeds << " seeds a pit." << std::endl;
+    }
     output_user_info(1, alg[1], heu[1], max_depth[1]);
     output_user_info(0, alg[0], heu[0], max_depth[0]);
     std::cout << std::endl << std::endl;
 
-    std::vector< int > board;
-    for(int i = 0; i < 14; i++){
-        if(i%7 == 6) board.push_back(0);
-        else board.push_back(6);
+    if(settings.pits == 4 && settings.seeds == 4){
+        play_kalah< 4, 4 >(alg, heu, max_depth, options, diag, diag_log);
+    } else if(settings.pits == 5 && settings.seeds == 5){
+        play_kalah< 5, 5 >(alg, heu, max_depth, options, diag, diag_log);
+    } else if(settings.pits == 6 && settings.seeds == 4){
+        play_kalah< 6, 4 >(alg, heu, max_depth, options, diag, diag_log);
+    } else{
+        play_kalah< 6, 6 >(alg, heu, max_depth, options, diag, diag_log);
     }
+    if(diag.is_open()) diag.close();
+    diag_log.close();
+    wait_for_user();
+    return 0;
+}
+
+template< int PITS, int SEEDS >
+void play_kalah(const std::vector< bool >& alg, const std::vector< int >& heu, const std::vector< int >& max_depth,
+                const PlayGame::Options& options, std::ofstream& diag, DiagLog& diag_log){
+    typedef KalahVariant< PITS, SEEDS > Variant;
+    const char *h_name[4];
+    h_name[0] = "Alabandi's H"; h_name[1] = "Bell's H";
+    h_name[2] = "Coplin's H"; h_name[3] = "The simple h";
+    bool is_player_one = 1;
+    std::vector< int > board = BasicPlayGame< PITS, SEEDS >::starting_board();
     std::cout << "Player " << 2 - is_player_one << "'s turn" << std::endl;
     printboard(board);
 
     int move_count = 1;
-    while(!game_over(board)){
+    while(!game_over< PITS, SEEDS >(board)){
+        if(options.table) options.table->new_search();
         std::chrono::high_resolution_clock::time_point time_before = std::chrono::high_resolution_clock::now();
-        PlayGame next_move(board, alg[is_player_one], is_player_one, heu[is_player_one], max_depth[is_player_one]);
+        BasicPlayGame< PITS, SEEDS > next_move(board, alg[is_player_one], is_player_one, heu[is_player_one], max_depth[is_player_one], options);
         std::chrono::high_resolution_clock::time_point time_after = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> seconds_used = std::chrono::duration_cast<std::chrono::duration<double>>(time_after - time_before);
         std::cout << "Player " <<  2 - is_player_one << " generated " << next_move.children_generated << " children in " << seconds_used.count() << " seconds." << std::endl;
+        if(options.quiescence_node_limit > 0) std::cout << "Quiescence looked at " << next_move.quiescence_nodes << " more." << std::endl;
+        if(options.reductions) std::cout << "Searched " << next_move.reduced_searches << " late moves reduced, "
+                                         << next_move.re_searches << " again in full." << std::endl;
+        if(options.table) std::cout << "Transposition table found " << next_move.table_hits << " of " << next_move.table_probes << " positions." << std::endl;
+        if(options.eval_cache) std::cout << "Evaluation cache found " << next_move.eval_hits << " of " << next_move.eval_probes << " boards." << std::endl;
+        if(next_move.budget_hit) std::cout << "Search budget reached, playing the best finished move." << std::endl;
         std::cout << h_name[heu[is_player_one]] << "euristic Move Score: " << next_move.heuristic_score << std::endl;
         std::cout << "Predicted Path: ";
         next_move.output_path();
         std::cout << std::endl << std::endl;
-        if(diag.is_open()) {
-            diag << move_count << ",";
-            diag << next_move.next_moves_board[6] << ",";
-            diag << next_move.next_moves_board[13] << ",";
-            diag << next_move.children_generated << ",";
-            diag << next_move.move[0];
-            for(int i = 1; i < next_move.move.size(); i++){
-                diag << " " << next_move.move[i];
-            }
-            diag << "," <<seconds_used.count() << ",";
-            diag << next_move.next_moves_board[0];
-            for(int i = 1; i < 14; i++){
-                diag << " " << next_move.next_moves_board[i];
-            }
-            diag << ",";
-            next_move.output_path(diag);
-            diag << "," << next_move.heuristic_score << std::endl;
+        if(diag.is_open() || diag_log.is_open()) {
+            DiagRecord record(move_count, next_move, seconds_used.count());
+            if(diag_log.is_open()) diag_log.write(record);
+            else write_diag_row(diag, record);
         }
         is_player_one = !is_player_one;
         board.clear();
-        for(int i = 0; i < 14; i++){
+        for(int i = 0; i < next_move.next_moves_board.size(); i++){
             board.push_back(next_move.next_moves_board[i]);
         }
         std::cout << std::endl;
@@ -101,28 +178,21 @@ int main(int argc, char* argv[]) {
         std::cout << std::endl;
         move_count++;
     }
-    if(board[6] > board[13]) std::cout << "Player 1 wins!" << std::endl;
-    else if(board[6] < board[13]) std::cout << "Player 2 wins!" << std::endl;
+    if(board[Variant::MAX_KALAH] > board[Variant::MIN_KALAH]) std::cout << "Player 1 wins!" << std::endl;
+    else if(board[Variant::MAX_KALAH] < board[Variant::MIN_KALAH]) std::cout << "Player 2 wins!" << std::endl;
     else std::cout << "Draw!" << std::endl;
-    if(diag.is_open()) diag.close();
-    wait_for_user();
-    return 0;
 }
 
-bool game_over(std::vector< int > board){
+template< int PITS, int SEEDS >
+bool game_over(const std::vector< int >& board){
     //if someone scores half of the board, the game is over.
-    if(board[6] > 36 || board[13] > 36) return true;
-
-    for(int i = 0; i < 6; i++){
-        if(board[i] != 0) return false;
-        if(board[12 - i] != 0) return false;
-    }
-    return true;
+    //The search uses the same test, see terminal_board.
+    return BasicPlayGame< PITS, SEEDS >::terminal_board(board);
 }
 
 void printboard(std::vector<int> field)
 {
-    int pits = 6;
+    int pits = field.size() / 2 - 1;
     using namespace std;
     //Default board
     //MIN: 12|11|10|9 |8 |7 |
@@ -217,4 +287,47 @@ void output_user_info(bool player_max, bool alg, int heuristic, int depth){
     cout << "Player " << 2 - player_max << " is using " << h_name[heuristic] << " heuristic in ";
     alg ? cout << "Norvig and Luger's " : cout << "Rich and Knight's ";
     cout << "minimax algorithm, with a cutoff depth of " << depth << "." << endl;
-}
\ No newline at end of file
+}
+
+bool parse_option(const std::string& arg, RunSettings& settings){
+    //options are of the form --name=value
+    std::size_t split = arg.find('=');
+    if(arg.compare(0, 2, "--") != 0 || split == std::string::npos) return false;
+    std::string name = arg.substr(2, split - 2);
+    std::string value = arg.substr(split + 1);
+    PlayGame::Options& options = settings.options;
+    if(name == "node-limit"){
+        options.node_limit = atol(value.c_str());
+    } else if(name == "memory-limit"){
+        options.memory_limit = (std::size_t)atol(value.c_str()) * 1024 * 1024;
+    } else if(name == "quiescence"){
+        options.quiescence_node_limit = atol(value.c_str());
+    } else if(name == "table"){
+        settings.table_size = (std::size_t)atol(value.c_str());
+    } else if(name == "eval-cache"){
+        settings.eval_cache_size = (std::size_t)atol(value.c_str());
+    } else if(name == "batch-leaves"){
+        options.batch_leaves = atoi(value.c_str()) != 0;
+    } else if(name == "variant"){
+        //only the variants PlayGame.cpp instantiates
+        if(value != "6,6" && value != "4,4" && value != "5,5" && value != "6,4") return false;
+        settings.pits = value[0] - '0';
+        settings.seeds = value[2] - '0';
+    } else if(name == "weights"){
+        if(!load_weights(value, options.weights)){
+            std::cout << "Can't read weights from " << value << std::endl;
+            return false;
+        }
+    } else if(name == "reductions"){
+        if(value != "default" && !load_reductions(value, settings.reductions)){
+            std::cout << "Can't read reductions from " << value << std::endl;
+            return false;
+        }
+        options.reductions = &settings.reductions;
+    } else if(name == "diag-thread"){
+        settings.diag_thread = atoi(value.c_str()) != 0;
+    } else{
+        return false;
+    }
+    return true;
+}